@@ -1,96 +1,66 @@
 #include "genetic.h"
 
-template<typename T>
-Genetic<T>::Genetic(const std::vector<size_t>& neurons,
+template<typename T, typename Storage>
+Genetic<T, Storage>::Genetic(const std::vector<size_t>& neurons,
         const std::vector<typename Activator<T>::Function>& activate,
-        T maxBiasValue, size_t populationSize) : gen(std::random_device{}()) {
+        T maxBiasValue, size_t populationSize) : random(next_random_stream()) {
     generations.reserve(populationSize);
-    Perceptrone<T> base_model(neurons, activate, maxBiasValue);
+    Perceptrone<T, Storage> base_model(neurons, activate, maxBiasValue);
     for(size_t i = 0; i < populationSize; i++) {
         generations.emplace_back(base_model);
     }
 }
 
 
-template<typename T>
-Perceptrone<T>& Genetic<T>::getModel(size_t numModel) {
+template<typename T, typename Storage>
+Perceptrone<T, Storage>& Genetic<T, Storage>::getModel(size_t numModel) {
     return generations[numModel].model;
 }
 
-template<typename T>
-const Perceptrone<T>& Genetic<T>::getModel(size_t numModel) const {
+template<typename T, typename Storage>
+const Perceptrone<T, Storage>& Genetic<T, Storage>::getModel(size_t numModel) const {
     return generations[numModel].model;
 }
 
-template<typename T>
-void Genetic<T>::setFitness(size_t numModel, T fitness) {
+template<typename T, typename Storage>
+void Genetic<T, Storage>::setFitness(size_t numModel, T fitness) {
     generations[numModel].fitness = fitness;
 }
 
-template<typename T>
-void Genetic<T>::mutate(Gen& gen, T mutationRate) {
-    std::uniform_real_distribution<T> prob_dist(0, 1);
-    std::normal_distribution<T> noise_dist(0, 0.1);
-
-    auto weights = gen.model.get_weights();
-    auto biases = gen.model.get_biases();
-
-    
-    for (auto& layer : weights) {
-        for (auto& neuron_weights : layer) {
-            for (auto& w : neuron_weights) {
-                if (prob_dist(this->gen) < mutationRate) {
-                    w += noise_dist(this->gen);
-                }
-            }
-        }
-    }
-
-    for (auto& layer : biases) {
-        for (auto& b : layer) {
-            if (prob_dist(this->gen) < mutationRate) {
-                b += noise_dist(this->gen);
-            }
-        }
-    }
-
-    gen.model.set_weights(weights);
-    gen.model.set_biases(biases);
+template<typename T, typename Storage>
+void Genetic<T, Storage>::mutate(size_t index, T mutationRate) {
+    const RandomStream stream = random.substream(2 * generation + 1).substream(index);
+    generations[index].model.perturb(stream, mutationRate, T(0.1));
 }
 
 
-template<typename T>
-void Genetic<T>::mutate(size_t index, T mutationRate) {
-    mutate(generations[index], mutationRate);
-}
-
+template<typename T, typename Storage>
+void Genetic<T, Storage>::tourSelect(size_t tournamentSize) {
+    if (spare.size() != generations.size()) spare = generations;
+    RandomStream pick = random.substream(2 * generation++);
+    const uint32_t population = uint32_t(generations.size());
 
-template<typename T>
-void Genetic<T>::tourSelect(size_t tournamentSize) {
-    std::vector<Gen> new_generation;
-    new_generation.reserve(generations.size());
-    std::uniform_int_distribution<size_t> dist(0, generations.size() - 1);
-    
     for (size_t i = 0; i < generations.size(); i++) {
-        size_t best_index = dist(gen);
+        size_t best_index = pick.below(population);
         T best_fitness = generations[best_index].fitness;
         for (size_t j = 1; j < tournamentSize; j++) {
-            size_t candidate_index = dist(gen);
+            size_t candidate_index = pick.below(population);
             const T candidate_fitness = generations[candidate_index].fitness;
             if (candidate_fitness > best_fitness) {
                 best_index = candidate_index;
                 best_fitness = candidate_fitness;
             }
         }
-        new_generation.push_back(generations[best_index]);
+        spare[i] = generations[best_index];
     }
     
-    generations = std::move(new_generation);
+    std::swap(generations, spare);
 }
 
-template<typename T>
-void Genetic<T>::rouletteSelect() {
+template<typename T, typename Storage>
+void Genetic<T, Storage>::rouletteSelect() {
     
+    RandomStream pick = random.substream(2 * generation++);
     std::vector<T> fitnesses;
     fitnesses.reserve(generations.size());
     T sum_fitness = T(0);
@@ -103,23 +73,25 @@ void Genetic<T>::rouletteSelect() {
    
     if (sum_fitness <= T(0)) return;
     
-    std::uniform_real_distribution<T> dist(0, sum_fitness);
-    std::vector<Gen> new_generation;
-    new_generation.reserve(generations.size());
+    if (spare.size() != generations.size()) spare = generations;
+    size_t selected = 0;
     for (size_t i = 0; i < generations.size(); i++) {
-        T r = dist(gen);
+        T r = pick.uniform(T(0), sum_fitness);
         T running_sum = T(0);
         for (size_t j = 0; j < generations.size(); j++) {
             running_sum += fitnesses[j];
             if (running_sum >= r) {
-                new_generation.push_back(generations[j]);
+                spare[selected++] = generations[j];
                 break;
             }
         }
     }
     
-    generations = std::move(new_generation);
+    spare.erase(spare.begin() + selected, spare.end());
+    std::swap(generations, spare);
 }
 
 template class Genetic<float>;
-template class Genetic<double>;
\ No newline at end of file
+template class Genetic<double>;
+template class Genetic<float, float16>;
+template class Genetic<float, bfloat16>;
\ No newline at end of file
@@ -3,35 +3,43 @@
 
 #include "Perceptrone.h"
 #include <vector>
-#include <random>
 #include <utility>
 
-template<typename T>
+// Storage is passed on to Perceptrone; float16 or bfloat16 halve the population's
+// memory, while mutation and selection still work in T.
+template<typename T, typename Storage = T>
 class Genetic {
     struct Gen {
         T fitness;
-        Perceptrone<T> model;
+        Perceptrone<T, Storage> model;
         
-        Gen(Perceptrone<T>&& m, T f = T(0)) : model(std::move(m)), fitness(f) {}
-        Gen(const Perceptrone<T>& m, T f = T(0)) : model(m), fitness(f) {}
+        Gen(Perceptrone<T, Storage>&& m, T f = T(0)) : model(std::move(m)), fitness(f) {}
+        Gen(const Perceptrone<T, Storage>& m, T f = T(0)) : model(m), fitness(f) {}
     };
 
     std::vector<Gen> generations;
-    std::mt19937 gen;
-
-    void mutate(Gen& g, T mutationRate);
+    // The generation before, overwritten by the next selection: assigning a model to
+    // one of the same topology copies its parameters into the storage already there,
+    // so selection allocates nothing once the population exists.
+    std::vector<Gen> spare;
+    // Selection in generation g draws from substream 2g, mutation of individual i
+    // from substream 2g + 1 / i, so mutate can run for several individuals at once.
+    RandomStream random;
+    uint64_t generation = 0;
 
 public:
     Genetic(const std::vector<size_t>& neurons,
             const std::vector<typename Activator<T>::Function>& activate,
             T maxBiasValue, size_t populationSize);
     
-    Perceptrone<T>& getModel(size_t numModel);
-    const Perceptrone<T>& getModel(size_t numModel) const;
+    Perceptrone<T, Storage>& getModel(size_t numModel);
+    const Perceptrone<T, Storage>& getModel(size_t numModel) const;
     void setFitness(size_t numModel, T fitness);
     
     void tourSelect(size_t tournamentSize);
     void rouletteSelect();
+    // Thread safe for distinct indices. Draws the same noise if called twice for
+    // one individual in one generation.
     void mutate(size_t index, T mutationRate);
     
     size_t getPopulationSize() const { return generations.size(); }
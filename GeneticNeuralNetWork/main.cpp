@@ -45,6 +45,12 @@ int main() {
         targets.push_back({T(x*x)});
     }
 
+    vector<T> batch_inputs;
+    for (const auto& input : inputs) {
+        batch_inputs.insert(batch_inputs.end(), input.begin(), input.end());
+    }
+    vector<T> predictions(inputs.size());
+
     T total_error = T(1000000);
 
     const T mutation_rate = 0.00005;
@@ -57,9 +63,9 @@ int main() {
             T model_error = T(0);
             auto& model = mlp.getModel(numberModel);
             
+            model.predict_batch(batch_inputs.data(), inputs.size(), 1, predictions.data());
             for (size_t i = 0; i < inputs.size(); i++) {
-                vector<T> prediction = model.predict(inputs[i]);
-                model_error += abs(targets[i][0] - prediction[0]);
+                model_error += abs(targets[i][0] - predictions[i]);
             }
             
             mlp.setFitness(numberModel, 1.0 / (1.0 + model_error)); 
@@ -1,2 +1,2 @@
 import os
-os.system("g++ test.cpp Perceptrone.cpp genetic.cpp -o test -lncurses && ./test")
\ No newline at end of file
+os.system("g++ -O2 -fno-trapping-math -I../NeuralNetWork test.cpp genetic.cpp ../NeuralNetWork/Perceptrone.cpp ../NeuralNetWork/simdKernels.cpp ../NeuralNetWork/simdKernelsSse2.cpp ../NeuralNetWork/simdKernelsAvx2.cpp ../NeuralNetWork/simdKernelsAvx512.cpp ../NeuralNetWork/allocationCounter.cpp ../NeuralNetWork/threadPool.cpp ../NeuralNetWork/modelFile.cpp ../NeuralNetWork/randomStream.cpp ../NeuralNetWork/randomStreamAvx2.cpp ../NeuralNetWork/randomStreamAvx512.cpp ../NeuralNetWork/binaryPerceptrone.cpp ../NeuralNetWork/binaryKernels.cpp ../NeuralNetWork/binaryKernelsAvx2.cpp ../NeuralNetWork/binaryKernelsAvx512.cpp -o test -lncurses -pthread && ./test")
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "genetic.h"
 #include "snake.hpp"
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 #include <ncurses.h>
 #pragma once
 
@@ -9,10 +11,10 @@ template<typename T>
 struct maxModel {
     static T Fitness;  
     
-    static void max(T fitness, Perceptrone<T>& mod) {
+    static void max(T fitness, Perceptrone<T>& mod, const char* filename) {
         if (Fitness < fitness) {
             Fitness = fitness;
-            mod.save_weights("weights.bin");
+            mod.save(filename);
         }
     }
 };
@@ -30,6 +32,12 @@ struct GeneticSnakeTrainerConfig {
     int max_steps_per_game = 10000;
      
     bool visualize = true;
+    // Scores each model by a game played by its binarized version (see
+    // BinaryPerceptrone), so the search favours models that survive binarization.
+    // The float models are still the ones evolved, and the best is saved to
+    // weights_binary.mlp instead of weights.mlp, since it only earns its score when
+    // binarized (test.cpp --binary plays it so). Needs T = float.
+    bool binary_policy = false;
     int target_score = 100;
     std::function<void(size_t, T, T)> on_generation_end = [](size_t, T, T){};
     std::function<void()> on_target_reached = [](){};
@@ -41,10 +49,28 @@ class SnakeTrainer {
 private:
     Genetic<T>* genTrainer;
     GeneticSnakeTrainerConfig<T> config;
+
+    const char* saved_model_file() const {
+        return config.binary_policy ? "weights_binary.mlp" : "weights.mlp";
+    }
+
+    int play(SnakeGame& game, Perceptrone<T>& model, bool render) {
+        if constexpr (std::is_same<T, float>::value) {
+            if (config.binary_policy) {
+                BinaryPerceptrone binary(model);
+                return render ? game.runWithRender(binary) : game.runWithoutRender(binary);
+            }
+        }
+        return render ? game.runWithRender(model) : game.runWithoutRender(model);
+    }
  
 public:
     SnakeTrainer(Genetic<T>& gen, const GeneticSnakeTrainerConfig<T>& cfg = {})
-        : genTrainer(&gen), config(cfg) {}
+        : genTrainer(&gen), config(cfg) {
+        if (config.binary_policy && !std::is_same<T, float>::value) {
+            throw std::invalid_argument("binary_policy needs a float model");
+        }
+    }
 
     void run() {
         size_t population_size = genTrainer->getPopulationSize();
@@ -70,9 +96,9 @@ public:
                 Perceptrone<T>& model = genTrainer->getModel(i);
                 
                 if (config.visualize && i == 0) { 
-                    int score = game.runWithRender(model);
+                    int score = play(game, model, true);
                     T fitness = static_cast<T>(score);
-                    maxModel<T>::max(fitness ,model);
+                    maxModel<T>::max(fitness, model, saved_model_file());
                     genTrainer->setFitness(i, fitness);
                     total_fitness += fitness;
                     
@@ -81,9 +107,9 @@ public:
                         best_index = i;
                     }
                 } else {
-                    int score = game.runWithoutRender(model);
+                    int score = play(game, model, false);
                     T fitness = static_cast<T>(score);
-                    maxModel<T>::max(fitness ,model);
+                    maxModel<T>::max(fitness, model, saved_model_file());
                     genTrainer->setFitness(i, fitness);
                     total_fitness += fitness;
                     
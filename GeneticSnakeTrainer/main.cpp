@@ -1,5 +1,6 @@
 #include "geneticSnakeTrainer.hpp"
 #include <iostream>
+#include <string>
 
 using namespace std;
 using T = float;
@@ -14,7 +15,7 @@ void onTargetReached() {
     cout << "\n=== TARGET SCORE REACHED! ===\n";
 }
 
-int main() {
+int main(int argc, char** argv) {
     
     const vector<size_t> neurons = {8,64, 64, 64,4}; 
     const vector<typename Activator<T>::Function> activations = {
@@ -43,6 +44,8 @@ int main() {
     trainer_config.target_score = 2000;
     trainer_config.visualize = 1;
     trainer_config.snake_config = snake_config;
+    // --binary: evolve models for their binarized version.
+    trainer_config.binary_policy = argc > 1 && string(argv[1]) == "--binary";
     
   
     trainer_config.on_generation_end = &printProgress;
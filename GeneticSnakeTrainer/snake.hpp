@@ -5,9 +5,9 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include<immintrin.h>
 #include <functional>
 #include"Perceptrone.h"
+#include"binaryPerceptrone.h"
 #pragma once
 
 struct Position {
@@ -153,6 +153,26 @@ private:
         curs_set(0);
     }
 
+    template<typename T, typename Model>
+    int renderGame(Model& model) {
+        T state[state_size];
+        if (model.get_sizes().front() != state_size) {
+            throw std::invalid_argument("Input size mismatch");
+        }
+        init_ncurses();
+        
+        while (!game_over) {
+            get_state(state);
+            update_direction(static_cast<int>(model.predict_argmax(state)));
+            update();
+            draw();
+            napms(50);
+        }
+        
+        endwin();
+        return score;
+    }
+
 public:
     SnakeGame(const SnakeConfig& cfg = {}) 
         : config(cfg),
@@ -193,9 +213,17 @@ public:
         }
     }
 
+    static constexpr size_t state_size = 8;
+
     template<typename T>
     std::vector<T> get_state() const {
-        std::vector<T> state(8);
+        std::vector<T> state(state_size);
+        get_state(state.data());
+        return state;
+    }
+
+    template<typename T>
+    void get_state(T* state) const {
         Position head = snake.front();
 
         int dx_current, dy_current;
@@ -246,8 +274,6 @@ public:
         
         state[7] = static_cast<T>(snake.size() - config.initial_length) / 
                   ((config.width-2)*(config.height-2) - config.initial_length);
-
-        return state;
     }
 
     void draw() const {
@@ -320,53 +346,46 @@ public:
 
     template<typename T>
     int runWithoutRender(Perceptrone<T>& model) {
+        typename Perceptrone<T>::Workspace ws(model);
+        return runWithoutRender(model, ws);
+    }
+
+    // Plays one game against a shared model; several games may run concurrently
+    // on the same model as long as each uses its own workspace.
+    template<typename T>
+    int runWithoutRender(const Perceptrone<T>& model, typename Perceptrone<T>::Workspace& ws) {
+        T state[state_size];
+        if (model.get_sizes().front() != state_size) {
+            throw std::invalid_argument("Input size mismatch");
+        }
         while (!game_over) {
-            auto state = get_state<T>();
-            auto output = model.predict(state);
-            
-            int action = 0;
-            T max_val = output[0];
-            for (int i = 1; i < output.size(); i++) {
-                if (output[i] > max_val) {
-                    max_val = output[i];
-                    action = i;
-                }
-            }
-            
-            update_direction(action);
+            get_state(state);
+            update_direction(static_cast<int>(model.predict_argmax(ws, state)));
             update_without_render();
         }
         
         return score;
     }
 
-    template<typename T>
-    int runWithRender(Perceptrone<T>& model) {
-        init_ncurses();
-        
+    // Plays one game with the binarized model, which keeps its own workspace.
+    int runWithoutRender(BinaryPerceptrone& model) {
+        float state[state_size];
+        if (model.get_sizes().front() != state_size) {
+            throw std::invalid_argument("Input size mismatch");
+        }
         while (!game_over) {
-            auto state = get_state<T>();
-            auto output = model.predict(state);
-            
-            int action = 0;
-            T max_val = output[0];
-            for (int i = 1; i < output.size(); i++) {
-                if (output[i] > max_val) {
-                    max_val = output[i];
-                    action = i;
-                }
-            }
-            
-            update_direction(action);
-            update();
-            draw();
-            napms(50);
+            get_state(state);
+            update_direction(static_cast<int>(model.predict_argmax(state)));
+            update_without_render();
         }
-        
-        endwin();
+
         return score;
     }
 
+    template<typename T>
+    int runWithRender(Perceptrone<T>& model) { return renderGame<T>(model); }
+    int runWithRender(BinaryPerceptrone& model) { return renderGame<float>(model); }
+
     void run() {
         try {
             init_ncurses();
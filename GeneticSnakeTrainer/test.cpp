@@ -1,9 +1,10 @@
 #include<iostream>
+#include<string>
 #include"snake.hpp"
 using namespace std;
 using T =float;
 
-int main(){
+int main(int argc, char** argv){
      SnakeConfig snake_config;
     snake_config.width = 5;
     snake_config.height = 5;
@@ -19,21 +20,17 @@ int main(){
     SnakeGame game(snake_config);
 
 
-    const vector<typename Activator<T>::Function> activations = {
-        Activator<T>::RELU,  
-        Activator<T>::RELU, 
-        Activator<T>::RELU,    
-        Activator<T>::IDENTITY 
-    };
+    // --binary: the model evolved with binary_policy, played by its binarized version.
+    const bool binary = argc > 1 && string(argv[1]) == "--binary";
+    Perceptrone<T> model = Perceptrone<T>::from_file(binary ? "weights_binary.mlp" : "weights.mlp");
 
-    const vector<size_t> neurons = {8,64, 64, 64,4};
-
-
-    Perceptrone<T> model(neurons,activations,0.3);
-
-    model.load_weights("weights.bin");
-
-    int score = game.runWithRender(model);
+    int score;
+    if (binary) {
+        BinaryPerceptrone binarized(model);
+        score = game.runWithRender(binarized);
+    } else {
+        score = game.runWithRender(model);
+    }
 
     cout<<endl<<score<<endl;
     
@@ -0,0 +1,80 @@
+# MLPCore, the network library, for this project and for the ones beside it
+# (GeneticSnakeTrainer, GeneticNeuralNetWork), which include this file rather than
+# keeping copies of the sources. Needs Threads::Threads to be found first.
+
+set(MLP_CORE_SOURCES
+    backpropagation.cpp
+    Perceptrone.cpp
+    simdKernels.cpp
+    simdKernelsSse2.cpp
+    simdKernelsAvx2.cpp
+    simdKernelsAvx512.cpp
+    allocationCounter.cpp
+    int8Kernels.cpp
+    int8KernelsAvx2.cpp
+    int8KernelsAvx512.cpp
+    int8KernelsVnni.cpp
+    quantizedPerceptrone.cpp
+    sparsePerceptrone.cpp
+    threadPool.cpp
+    mappedFile.cpp
+    mappedPerceptrone.cpp
+    modelFile.cpp
+    randomStream.cpp
+    randomStreamAvx2.cpp
+    randomStreamAvx512.cpp
+    inferenceServer.cpp
+    kernelTuner.cpp
+    binaryKernels.cpp
+    binaryKernelsAvx2.cpp
+    binaryKernelsAvx512.cpp
+    binaryPerceptrone.cpp
+    neuronPruning.cpp
+)
+
+
+set(MLP_CORE_HEADERS
+    backpropagation.h
+    exec_time.h
+    Perceptrone.h
+    mlpActivators.hpp
+    alignedAllocator.hpp
+    halfFloat.hpp
+    fastActivations.hpp
+    simdKernels.h
+    simdKernelsImpl.hpp
+    staticPerceptrone.hpp
+    span.hpp
+    allocationCounter.h
+    int8Kernels.h
+    int8KernelsImpl.hpp
+    int8KernelsAvx512Impl.hpp
+    quantizedPerceptrone.h
+    sparsePerceptrone.h
+    threadPool.h
+    mappedFile.h
+    mappedPerceptrone.h
+    modelFile.h
+    randomStream.h
+    randomStreamImpl.hpp
+    inferenceServer.h
+    generatedModel.hpp
+    kernelTuner.h
+    binaryKernels.h
+    binaryPerceptrone.h
+    neuronPruning.h
+    modelSnapshots.h
+)
+
+set(MLP_CORE_FILES)
+foreach(file ${MLP_CORE_SOURCES} ${MLP_CORE_HEADERS})
+    list(APPEND MLP_CORE_FILES ${CMAKE_CURRENT_LIST_DIR}/${file})
+endforeach()
+
+add_library(MLPCore STATIC ${MLP_CORE_FILES})
+target_link_libraries(MLPCore PUBLIC Threads::Threads)
+target_include_directories(MLPCore PUBLIC ${CMAKE_CURRENT_LIST_DIR})
+# Lets GCC if-convert the clamps and selects in the activation epilogues so they
+# vectorize; no kernel depends on floating-point exception flags.
+target_compile_options(MLPCore PRIVATE $<$<CXX_COMPILER_ID:GNU>:-fno-trapping-math>)
+target_compile_definitions(MLPCore PUBLIC $<$<CONFIG:Debug>:MLP_COUNT_ALLOCATIONS>)
@@ -1,37 +1,134 @@
 #include"Perceptrone.h"
+#include <cstdio>
+#include <type_traits>
 
-template<typename T>
-T Perceptrone<T>::random_float(T min, T max) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_real_distribution<T> dist(min, max);
-    return dist(gen);
-}
-
-template<typename T>
-void Perceptrone<T>::calculate() {
-    for (size_t layer = 1; layer < data.size(); layer++) {
-        for (size_t neuron = 0; neuron < data[layer].size(); neuron++) {
-            data[layer][neuron] = bias[layer][neuron];
-            for (size_t prev_neuron = 0; prev_neuron < data[layer - 1].size(); prev_neuron++) {
-                data[layer][neuron] += weights[layer - 1][prev_neuron][neuron] * data[layer - 1][prev_neuron];
-            }
-             
-        }
-        
-        for (auto& val : data[layer]) {
-            val = activations[layer - 1](val);
+template<typename T, typename Storage>
+Perceptrone<T, Storage>::Workspace::Workspace(const Perceptrone& model)
+    : topology(model.topology), data(model.topology->activationOffset.back(), T(0)) {}
+
+template<typename T, typename Storage>
+Perceptrone<T, Storage>::IncrementalState::IncrementalState(const Perceptrone& model, size_t refresh_interval)
+    : ws(model), refreshInterval(refresh_interval), sinceRefresh(refresh_interval) {
+    columns.assign(model.get_sizes()[0] * model.stride(1), Storage(T(0)));
+    copy_columns(model);
+    preactivation.assign(model.stride(1), T(0));
+}
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::IncrementalState::copy_columns(const Perceptrone& model) {
+    const std::vector<size_t>& sizes = model.get_sizes();
+    const size_t out_stride = model.stride(1);
+    const LayerView<Storage> layer = model.layer_weights(0);
+    for (size_t i = 0; i < sizes[0]; ++i) {
+        for (size_t n = 0; n < sizes[1]; ++n) {
+            columns[i * out_stride + n] = layer(i, n);
         }
     }
+    parameters = model.parameterId.value;
 }
 
-template<typename T>
-Perceptrone<T>::Perceptrone(const std::vector<size_t>& neurons,
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::check_workspace(const Workspace& ws) const {
+    if (ws.topology != topology && (!ws.topology || ws.topology->sizes != topology->sizes)) {
+        throw std::invalid_argument("Workspace does not match network structure");
+    }
+}
+
+template<typename T, typename Storage>
+template<typename F>
+void Perceptrone<T, Storage>::for_output_ranges(size_t outputs, bool parallel, F&& f) const {
+    if (!threadPool || !parallel) {
+        f(size_t(0), outputs);
+        return;
+    }
+    // Whole blocks of outputs per task so threads never share a cache line of y.
+    const size_t per_task = padded_size<T>((outputs + threadPool->size() - 1) / threadPool->size());
+    const size_t tasks = (outputs + per_task - 1) / per_task;
+    threadPool->parallel_for(tasks, [&](size_t task) {
+        const size_t first = task * per_task;
+        f(first, std::min(per_task, outputs - first));
+    });
+}
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::calculate(Workspace& ws, size_t begin, size_t end) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    const auto& activations = topology->activations;
+    if (end == 0) end = sizes.size();
+    for (size_t layer = begin; layer < end; layer++) {
+        const size_t in_stride = stride(layer - 1);
+        const Storage* w = weight_data(layer - 1);
+        const Storage* b = bias_data(layer);
+        const T* x = ws.layer(layer - 1);
+        T* y = ws.layer(layer);
+        const SimdKernels<T, Storage>& k = layer_kernels(layer - 1);
+        for_output_ranges(sizes[layer], parallel_layer(layer - 1), [&](size_t first, size_t count) {
+            k.gemv(w + first * in_stride, in_stride, count, x, b + first, y + first,
+                          activations[layer - 1], activationParameters);
+        });
+    }
+}
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::calculate_batch(Workspace& ws, size_t rows) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    const auto& activations = topology->activations;
+    for (size_t layer = 1; layer < sizes.size(); layer++) {
+        const size_t in_stride = stride(layer - 1);
+        const Storage* w = weight_data(layer - 1);
+        const Storage* b = bias_data(layer);
+        const T* x = ws.batch_layer(layer - 1);
+        T* y = ws.batch_layer(layer);
+        const SimdKernels<T, Storage>& k = layer_kernels(layer - 1);
+        const bool parallel = rows * sizes[layer] * in_stride >= parallelWork;
+        for_output_ranges(sizes[layer], parallel, [&](size_t first, size_t count) {
+            k.gemm(w + first * in_stride, in_stride, count, x, rows, b + first,
+                          y + first, stride(layer), activations[layer - 1], activationParameters);
+        });
+    }
+}
+
+template<typename T, typename Storage>
+std::shared_ptr<const typename Perceptrone<T, Storage>::Topology> Perceptrone<T, Storage>::make_topology(
+        const std::vector<size_t>& sizes, const std::vector<typename Activator<T>::Function>& activations) {
+    auto topology = std::make_shared<Topology>();
+    topology->sizes = sizes;
+    topology->activations = activations;
+    size_t offset = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        topology->biasOffset.push_back(offset);
+        offset += padded_size<Storage>(sizes[i]);
+    }
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        topology->weightOffset.push_back(offset);
+        offset += padded_size<Storage>(sizes[i + 1] * padded_size<T>(sizes[i]));
+    }
+    topology->parameterCount = offset;
+    topology->activationOffset.push_back(0);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        topology->activationOffset.push_back(topology->activationOffset.back() + padded_size<T>(sizes[i]));
+    }
+    return topology;
+}
+
+
+template<typename T, typename Storage>
+Perceptrone<T, Storage>::Perceptrone(const std::vector<size_t>& neurons,
+            const std::vector<typename Activator<T>::Function>& activate,
+            T maxBiasValue,
+            const typename Activator<T>::Parameters& parameters)
+    : Perceptrone(Unset(), neurons, activate, parameters) {
+    randomize(next_random_stream(), maxBiasValue);
+}
+
+
+template<typename T, typename Storage>
+Perceptrone<T, Storage>::Perceptrone(Unset, const std::vector<size_t>& neurons,
             const std::vector<typename Activator<T>::Function>& activate,
-            T maxBiasValue) {
+            const typename Activator<T>::Parameters& parameters)
+    : activationParameters(parameters), kernels(&simd_kernels<T, Storage>()) {
     Activator<T> activator(activate);
-    activations = activator.getActivations();
-    activationDerivatives = activator.getDerivatives();
+    const auto& activations = activator.getFunctions();
 
     if (neurons.size() < 2) {
         throw std::invalid_argument("Network must have at least 2 layers");
@@ -41,157 +138,612 @@ Perceptrone<T>::Perceptrone(const std::vector<size_t>& neurons,
         throw std::invalid_argument("Mismatch between layers and activations");
     }
 
-    bias.resize(neurons.size());
-    for (size_t i = 0; i < neurons.size(); ++i) {
-        bias[i].resize(neurons[i]);
-        T co = T(0);
-        for (auto& val : bias[i]) {
-            val = random_float( -maxBiasValue, maxBiasValue);
-            co += T(1);
+    topology = make_topology(neurons, activations);
+    parameterValues.assign(topology->parameterCount, Storage(T(0)));
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::set_kernel_plan(const std::vector<LayerKernelChoice>& plan) {
+    if (!plan.empty() && plan.size() != topology->sizes.size() - 1) {
+        throw std::invalid_argument("Kernel plan must have one entry per weight layer");
+    }
+    kernelPlan = plan;
+    planKernels.clear();
+    for (const LayerKernelChoice& choice : plan) {
+        planKernels.push_back(&simd_kernels<T, Storage>(choice.isa));
+    }
+}
+
+
+template<typename T, typename Storage>
+std::vector<LayerKernelChoice> Perceptrone<T, Storage>::get_kernel_plan() const {
+    if (!kernelPlan.empty()) return kernelPlan;
+    std::vector<LayerKernelChoice> plan;
+    for (size_t layer = 0; layer + 1 < topology->sizes.size(); ++layer) {
+        plan.push_back({kernels->isa, threadPool != nullptr && parallel_layer(layer)});
+    }
+    return plan;
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::randomize(const RandomStream& rng, T maxBiasValue) {
+    parameterId.renew();
+    const std::vector<size_t>& sizes = topology->sizes;
+    std::vector<T> row(*std::max_element(sizes.begin(), sizes.end()));
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        rng.substream(2 * i).fill_uniform(row.data(), sizes[i], -maxBiasValue, maxBiasValue);
+        std::copy(row.begin(), row.begin() + sizes[i], bias_data(i));
+    }
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        RandomStream layer = rng.substream(2 * i + 1);
+        const T scale = std::sqrt(T(2) / static_cast<T>(sizes[i]));
+        for (size_t k = 0; k < sizes[i + 1]; ++k) {
+            layer.fill_uniform(row.data(), sizes[i], -scale, scale);
+            std::copy(row.begin(), row.begin() + sizes[i], weight_data(i) + k * stride(i));
+        }
+    }
+}
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::perturb(const RandomStream& rng, T rate, T sigma) {
+    parameterId.renew();
+    const std::vector<size_t>& sizes = topology->sizes;
+    std::vector<T> draws, noise;
+    // Perturbs a rows x cols matrix with rows `row_stride` apart from substream `index`.
+    auto perturb_matrix = [&](Storage* values, size_t rows, size_t cols, size_t row_stride, uint64_t index) {
+        RandomStream stream = rng.substream(index);
+        draws.resize(rows * cols);
+        stream.fill_uniform(draws.data(), draws.size(), T(0), T(1));
+        const size_t hits = std::count_if(draws.begin(), draws.end(), [rate](T d) { return d < rate; });
+        noise.resize(hits);
+        stream.fill_normal(noise.data(), hits, T(0), sigma);
+        size_t h = 0;
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < cols; ++c) {
+                if (draws[r * cols + c] < rate) {
+                    Storage& v = values[r * row_stride + c];
+                    v = Storage(static_cast<T>(v) + noise[h++]);
+                }
+            }
+        }
+    };
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        perturb_matrix(bias_data(i), 1, sizes[i], sizes[i], 2 * i);
+    }
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        perturb_matrix(weight_data(i), sizes[i + 1], sizes[i], stride(i), 2 * i + 1);
+    }
+}
+
+template<typename T, typename Storage>
+std::vector<T> Perceptrone<T, Storage>::predict(const std::vector<T>& input) {
+    return predict(own_workspace(), input);
+}
+
+
+template<typename T, typename Storage>
+std::vector<T> Perceptrone<T, Storage>::predict(Workspace& ws, const std::vector<T>& input) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (input.size() != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    std::vector<T> output(sizes.back());
+    predict_into(ws, input.data(), output.data());
+    return output;
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_into(const T* input, T* output) {
+    predict_into(own_workspace(), input, output);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_into(Workspace& ws, const T* input, T* output) const {
+    check_workspace(ws);
+    const std::vector<size_t>& sizes = topology->sizes;
+    std::copy(input, input + sizes.front(), ws.layer(0));
+    calculate(ws);
+    std::copy(ws.layer(sizes.size() - 1), ws.layer(sizes.size() - 1) + sizes.back(), output);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_into(Span<const T> input, Span<T> output) {
+    predict_into(own_workspace(), input, output);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_into(Workspace& ws, Span<const T> input, Span<T> output) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (input.size() != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    if (output.size() != sizes.back()) {
+        throw std::invalid_argument("Output size mismatch");
+    }
+    predict_into(ws, input.data(), output.data());
+}
+
+
+template<typename T, typename Storage>
+size_t Perceptrone<T, Storage>::predict_argmax(const T* input) {
+    return predict_argmax(own_workspace(), input);
+}
+
+
+template<typename T, typename Storage>
+size_t Perceptrone<T, Storage>::predict_argmax(Workspace& ws, const T* input) const {
+    size_t index;
+    predict_top_k(ws, input, 1, &index);
+    return index;
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_top_k(const T* input, size_t k, size_t* indices, T* values) {
+    predict_top_k(own_workspace(), input, k, indices, values);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_top_k(Workspace& ws, const T* input, size_t k, size_t* indices, T* values) const {
+    check_workspace(ws);
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (k == 0 || k > sizes.back()) {
+        throw std::invalid_argument("k must be between 1 and the output size");
+    }
+    const size_t last = sizes.size() - 1;
+    std::copy(input, input + sizes.front(), ws.layer(0));
+    calculate(ws, 1, last);
+    // The output layer is never written by the head, so it holds the values if the
+    // caller does not want them.
+    layer_kernels(last - 1).gemv_top_k(weight_data(last - 1), stride(last - 1), sizes[last], ws.layer(last - 1),
+                        bias_data(last), topology->activations[last - 1], activationParameters,
+                        k, indices, values ? values : ws.layer(last));
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_softmax(const T* input, T* output) {
+    predict_softmax(own_workspace(), input, output);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_softmax(Workspace& ws, const T* input, T* output) const {
+    check_workspace(ws);
+    const std::vector<size_t>& sizes = topology->sizes;
+    const size_t last = sizes.size() - 1;
+    std::copy(input, input + sizes.front(), ws.layer(0));
+    calculate(ws, 1, last);
+    layer_kernels(last - 1).gemv_softmax(weight_data(last - 1), stride(last - 1), sizes[last], ws.layer(last - 1),
+                          bias_data(last), output, topology->activations[last - 1], activationParameters);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_incremental(IncrementalState& state, const T* input, T* output) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    Workspace& ws = state.ws;
+    check_workspace(ws);
+    if (state.columns.size() != sizes[0] * stride(1)) {
+        throw std::invalid_argument("Incremental state does not match network structure");
+    }
+    if (state.parameters != parameterId.value) {
+        state.copy_columns(*this);
+        state.sinceRefresh = state.refreshInterval;
+    }
+
+    const size_t inputs = sizes.front();
+    const size_t out_stride = stride(1);
+    const SimdKernels<T, Storage>& k = layer_kernels(0);
+    T* previous = ws.layer(0);
+    T* z = state.preactivation.data();
+    size_t changed = 0;
+    bool full = state.sinceRefresh >= state.refreshInterval;
+    for (size_t i = 0; i < inputs; i++) {
+        if (input[i] != previous[i]) {
+            changed++;
+            full = full || !std::isfinite(input[i]) || !std::isfinite(previous[i]);
         }
     }
 
-    weights.resize(neurons.size() - 1);
-    for (size_t i = 0; i < neurons.size() - 1; ++i) {
-        T scale = std::sqrt(T(2) / static_cast<T>(neurons[i]));
-        weights[i].resize(neurons[i]);
-        for (size_t j = 0; j < neurons[i]; ++j) {
-            weights[i][j].resize(neurons[i + 1]);
-            for (size_t k = 0; k < neurons[i + 1]; ++k) {
-                weights[i][j][k] = random_float(-scale, scale);
+    if (full || 2 * changed > inputs) {
+        std::copy(input, input + inputs, previous);
+        const size_t in_stride = stride(0);
+        const Storage* w = weight_data(0);
+        const Storage* b = bias_data(1);
+        for_output_ranges(sizes[1], parallel_layer(0), [&](size_t first, size_t count) {
+            k.gemv(w + first * in_stride, in_stride, count, previous, b + first, z + first,
+                          Activator<T>::IDENTITY, activationParameters);
+        });
+        state.sinceRefresh = 0;
+    } else {
+        for (size_t i = 0; i < inputs && changed > 0; i++) {
+            if (input[i] != previous[i]) {
+                k.axpy(input[i] - previous[i], state.columns.data() + i * out_stride, out_stride, z);
+                previous[i] = input[i];
+                changed--;
             }
         }
+        state.sinceRefresh++;
     }
 
-    data.resize(neurons.size());
-    for (size_t i = 0; i < neurons.size(); ++i) {
-        data[i].resize(neurons[i]);
+    T* y = ws.layer(1);
+    std::copy(z, z + sizes[1], y);
+    k.activate(y, sizes[1], topology->activations[0], activationParameters);
+    calculate(ws, 2);
+    std::copy(ws.layer(sizes.size() - 1), ws.layer(sizes.size() - 1) + sizes.back(), output);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_batch(const T* input, size_t rows, size_t cols, T* output) {
+    predict_batch(own_workspace(), input, rows, cols, output);
+}
+
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::predict_batch(Workspace& ws, const T* input, size_t rows, size_t cols, T* output) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (cols != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    check_workspace(ws);
+
+    if (rows > ws.batchRows) {
+        ws.batchData.assign(rows * topology->activationOffset.back(), T(0));
+        ws.batchRows = rows;
+    }
+
+    const size_t in_stride = stride(0);
+    for (size_t row = 0; row < rows; row++) {
+        std::copy(input + row * cols, input + (row + 1) * cols, ws.batch_layer(0) + row * in_stride);
+    }
+
+    calculate_batch(ws, rows);
+
+    const size_t outputs = sizes.back();
+    const size_t out_stride = stride(sizes.size() - 1);
+    for (size_t row = 0; row < rows; row++) {
+        const T* y = ws.batch_layer(sizes.size() - 1) + row * out_stride;
+        std::copy(y, y + outputs, output + row * outputs);
     }
 }
 
 
-template<typename T>
-std::vector<T> Perceptrone<T>::predict(const std::vector<T>& input) {
-    if (input.size() != data[0].size()) {
+template<typename T, typename Storage>
+std::vector<T> Perceptrone<T, Storage>::predict_batch(const std::vector<T>& input, size_t rows) {
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (input.size() != rows * sizes.front()) {
         throw std::invalid_argument("Input size mismatch");
     }
-    data[0] = input;
-    calculate();
-    return data.back();
+    std::vector<T> output(rows * sizes.back());
+    predict_batch(input.data(), rows, sizes.front(), output.data());
+    return output;
 }
 
 
+template<typename T, typename Storage>
+LayerView<Storage> Perceptrone<T, Storage>::layer_weights(size_t layer) const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    return {weight_data(layer), sizes[layer], sizes[layer + 1], stride(layer)};
+}
+
 
-template<typename T>
-const std::vector<std::vector<std::vector<T>>>& Perceptrone<T>::get_weights() const {
-    return weights;
+template<typename T, typename Storage>
+std::vector<std::vector<std::vector<T>>> Perceptrone<T, Storage>::get_weights() const {
+    std::vector<std::vector<std::vector<T>>> nested(topology->weightOffset.size());
+    for (size_t i = 0; i < nested.size(); ++i) {
+        LayerView<Storage> view = layer_weights(i);
+        nested[i].assign(view.inputs, std::vector<T>(view.outputs));
+        for (size_t j = 0; j < view.inputs; ++j) {
+            for (size_t k = 0; k < view.outputs; ++k) {
+                nested[i][j][k] = view(j, k);
+            }
+        }
+    }
+    return nested;
 }
 
 
-template<typename T>
-const std::vector<std::vector<T>>& Perceptrone<T>::get_biases() const {
-    return bias;
+template<typename T, typename Storage>
+std::vector<std::vector<T>> Perceptrone<T, Storage>::get_biases() const {
+    const std::vector<size_t>& sizes = topology->sizes;
+    std::vector<std::vector<T>> copy(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        copy[i].assign(bias_data(i), bias_data(i) + sizes[i]);
+    }
+    return copy;
 }
 
 
-template<typename T>
-void Perceptrone<T>::set_weights(const std::vector<std::vector<std::vector<T>>>& new_weights) {
-    if (new_weights.size() != weights.size()) {
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::set_weights(const std::vector<std::vector<std::vector<T>>>& new_weights) {
+    parameterId.renew();
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (new_weights.size() != sizes.size() - 1) {
         throw std::invalid_argument("Invalid number of weight layers");
     }
     
-    for (size_t i = 0; i < weights.size(); ++i) {
-        if (new_weights[i].size() != weights[i].size()) {
+    for (size_t i = 0; i < new_weights.size(); ++i) {
+        if (new_weights[i].size() != sizes[i]) {
             throw std::invalid_argument("Invalid number of neurons in weight layer " + std::to_string(i));
         }
         
-        for (size_t j = 0; j < weights[i].size(); ++j) {
-            if (new_weights[i][j].size() != weights[i][j].size()) {
+        for (size_t j = 0; j < sizes[i]; ++j) {
+            if (new_weights[i][j].size() != sizes[i + 1]) {
                 throw std::invalid_argument("Invalid number of connections in layer " 
                     + std::to_string(i) + " neuron " + std::to_string(j));
             }
         }
     }
     
-    weights = new_weights;
+    for (size_t i = 0; i < new_weights.size(); ++i) {
+        for (size_t j = 0; j < sizes[i]; ++j) {
+            for (size_t k = 0; k < sizes[i + 1]; ++k) {
+                weight(i, j, k) = new_weights[i][j][k];
+            }
+        }
+    }
 }
 
 
-template<typename T>
-void Perceptrone<T>::set_biases(const std::vector<std::vector<T>>& new_biases) {
-    if (new_biases.size() != bias.size()) {
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::set_biases(const std::vector<std::vector<T>>& new_biases) {
+    parameterId.renew();
+    const std::vector<size_t>& sizes = topology->sizes;
+    if (new_biases.size() != sizes.size()) {
         throw std::invalid_argument("Invalid number of bias layers");
     }
     
-    for (size_t i = 0; i < bias.size(); ++i) {
-        if (new_biases[i].size() != bias[i].size()) {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        if (new_biases[i].size() != sizes[i]) {
             throw std::invalid_argument("Invalid number of neurons in bias layer " + std::to_string(i));
         }
     }
     
-    bias = new_biases;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        std::copy(new_biases[i].begin(), new_biases[i].end(), bias_data(i));
+    }
 }
 
 
-template<typename T>
-void Perceptrone<T>::save_weights(const std::string& filename) const {
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::save_weights(const std::string& filename) const {
     std::ofstream file(filename, std::ios::binary);
     if (!file) throw std::runtime_error("Cannot open file for writing");
 
-    size_t num_layers = bias.size();
+    const std::vector<size_t>& sizes = topology->sizes;
+    size_t num_layers = sizes.size();
     file.write(reinterpret_cast<const char*>(&num_layers), sizeof(num_layers));
     
-    for (const auto& layer : bias) {
-        size_t size = layer.size();
+    for (size_t size : sizes) {
         file.write(reinterpret_cast<const char*>(&size), sizeof(size));
     }
 
-    for (const auto& layer : weights) {
-        for (const auto& neuron_weights : layer) {
-            file.write(reinterpret_cast<const char*>(neuron_weights.data()),
-                       neuron_weights.size() * sizeof(T));
+    std::vector<Storage> row;
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        LayerView<Storage> view = layer_weights(i);
+        row.resize(view.outputs);
+        for (size_t j = 0; j < view.inputs; ++j) {
+            for (size_t k = 0; k < view.outputs; ++k) {
+                row[k] = view(j, k);
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(Storage));
         }
     }
 
-    for (const auto& layer : bias) {
-        file.write(reinterpret_cast<const char*>(layer.data()),
-                   layer.size() * sizeof(T));
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        file.write(reinterpret_cast<const char*>(bias_data(i)), sizes[i] * sizeof(Storage));
     }
 }
 
-template<typename T>
-void Perceptrone<T>::load_weights(const std::string& filename) {
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::load_weights(const std::string& filename) {
     std::ifstream file(filename, std::ios::binary);
     if (!file) throw std::runtime_error("Cannot open file for reading");
 
-    size_t num_layers;
+    const std::vector<size_t>& sizes = topology->sizes;
+    size_t num_layers = 0;
     file.read(reinterpret_cast<char*>(&num_layers), sizeof(num_layers));
-    if (num_layers != bias.size()) {
+    if (num_layers != sizes.size()) {
         throw std::runtime_error("Network structure mismatch");
     }
 
-    std::vector<size_t> layer_sizes(num_layers);
     for (size_t i = 0; i < num_layers; ++i) {
-        size_t size;
+        size_t size = 0;
         file.read(reinterpret_cast<char*>(&size), sizeof(size));
-        if (size != bias[i].size()) {
+        if (size != sizes[i]) {
             throw std::runtime_error("Layer size mismatch");
         }
     }
 
-    for (auto& layer : weights) {
-        for (auto& neuron_weights : layer) {
-            file.read(reinterpret_cast<char*>(neuron_weights.data()),
-                      neuron_weights.size() * sizeof(T));
+    if (std::is_same<T, Storage>::value) {
+        read_parameters<Storage>(file);
+    } else {
+        // A 16-bit model also reads files of T values; tell them apart by length.
+        size_t count = 0;
+        for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+            count += sizes[i] * sizes[i + 1];
         }
+        for (size_t size : sizes) {
+            count += size;
+        }
+        const std::streampos start = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::streamoff remaining = file.tellg() - start;
+        file.seekg(start);
+
+        if (remaining == std::streamoff(count * sizeof(Storage))) {
+            read_parameters<Storage>(file);
+        } else if (remaining == std::streamoff(count * sizeof(T))) {
+            read_parameters<T>(file);
+        } else {
+            throw std::runtime_error("Unexpected weights file size");
+        }
+    }
+    // A truncated file would otherwise load with its missing parameters left as they were.
+    if (!file) throw std::runtime_error("Unexpected end of weights file");
+    if (file.peek() != std::ifstream::traits_type::eof()) {
+        throw std::runtime_error("Unexpected data after the weights");
+    }
+}
+
+template<typename T, typename Storage>
+void Perceptrone<T, Storage>::save(const std::string& filename) const {
+    const std::string temporary = filename + ".tmp";
+    std::ofstream file(temporary, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open file for writing");
+
+    const std::vector<size_t>& sizes = topology->sizes;
+    ModelHeader header;
+    header.compute_type = value_type_of<T>();
+    header.storage_type = value_type_of<Storage>();
+    header.sizes = sizes;
+    header.activations.assign(topology->activations.begin(), topology->activations.end());
+    header.alpha = activationParameters.alpha;
+    header.selu_alpha = activationParameters.selu_alpha;
+    header.selu_scale = activationParameters.selu_scale;
+    write_model_header(file, header);
+
+    uint32_t crc = 0;
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        crc = write_model_section(file, weight_data(i), sizes[i + 1] * stride(i) * sizeof(Storage), crc);
+        crc = write_model_section(file, bias_data(i + 1), sizes[i + 1] * sizeof(Storage), crc);
+    }
+    try {
+        finish_model_file(file, header, crc);
+        file.close();
+        if (!file) throw std::runtime_error("Cannot write weights file");
+    } catch (...) {
+        file.close();
+        std::remove(temporary.c_str());
+        throw;
+    }
+    // Where rename does not replace an existing file, the old one goes first.
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0 &&
+        (std::remove(filename.c_str()) != 0 || std::rename(temporary.c_str(), filename.c_str()) != 0)) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot replace model file");
+    }
+}
+
+template<typename T, typename Storage>
+Perceptrone<T, Storage> Perceptrone<T, Storage>::from_file(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open file for reading");
+
+    const ModelHeader header = read_model_header(file);
+    if (header.compute_type != value_type_of<T>()) {
+        throw std::runtime_error(std::string("Model file computes in ") + value_type_name(header.compute_type));
+    }
+    std::vector<typename Activator<T>::Function> functions;
+    for (uint32_t f : header.activations) {
+        functions.push_back(typename Activator<T>::Function(f));
+    }
+    typename Activator<T>::Parameters parameters;
+    parameters.alpha = T(header.alpha);
+    parameters.selu_alpha = T(header.selu_alpha);
+    parameters.selu_scale = T(header.selu_scale);
+
+    Perceptrone model(Unset(), header.sizes, functions, parameters);
+    uint32_t crc;
+    if (header.storage_type == value_type_of<Storage>()) {
+        crc = model.template read_model_payload<Storage>(file);
+    } else if (header.storage_type == value_type_of<T>()) {
+        crc = model.template read_model_payload<T>(file);
+    } else {
+        throw std::runtime_error(std::string("Model file stores ") + value_type_name(header.storage_type));
+    }
+    if (crc != header.payload_crc) {
+        throw std::runtime_error("Model file checksum mismatch");
+    }
+    return model;
+}
+
+template<typename T, typename Storage>
+template<typename U>
+uint32_t Perceptrone<T, Storage>::read_model_payload(std::istream& file) {
+    parameterId.renew();
+    uint32_t crc = 0;
+    std::vector<U> values;
+    char padding[MLP_ALIGNMENT];
+    auto read_section = [&](size_t count) {
+        values.resize(count);
+        const size_t bytes = count * sizeof(U);
+        const size_t pad = (MLP_ALIGNMENT - bytes % MLP_ALIGNMENT) % MLP_ALIGNMENT;
+        file.read(reinterpret_cast<char*>(values.data()), bytes);
+        file.read(padding, pad);
+        if (!file) throw std::runtime_error("Unexpected end of weights file");
+        crc = crc32(values.data(), bytes, crc);
+        crc = crc32(padding, pad, crc);
+    };
+    const std::vector<size_t>& sizes = topology->sizes;
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        read_section(sizes[i + 1] * stride(i));
+        std::transform(values.begin(), values.end(), weight_data(i),
+                       [](U v) { return Storage(static_cast<T>(v)); });
+        read_section(sizes[i + 1]);
+        std::transform(values.begin(), values.end(), bias_data(i + 1),
+                       [](U v) { return Storage(static_cast<T>(v)); });
     }
+    return crc;
+}
 
-    for (auto& layer : bias) {
-        file.read(reinterpret_cast<char*>(layer.data()),
-                  layer.size() * sizeof(T));
+template<typename T, typename Storage>
+Perceptrone<T, Storage> Perceptrone<T, Storage>::from_legacy_file(const std::string& filename,
+        const std::vector<typename Activator<T>::Function>& activate,
+        const typename Activator<T>::Parameters& parameters) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open file for reading");
+
+    size_t num_layers = 0;
+    file.read(reinterpret_cast<char*>(&num_layers), sizeof(num_layers));
+    if (!file || num_layers < 2 || num_layers != activate.size() + 1) {
+        throw std::runtime_error("Network structure mismatch");
     }
+    std::vector<size_t> layer_sizes(num_layers);
+    file.read(reinterpret_cast<char*>(layer_sizes.data()), num_layers * sizeof(size_t));
+    if (!file) throw std::runtime_error("Unexpected end of weights file");
+
+    Perceptrone model(Unset(), layer_sizes, activate, parameters);
+    model.load_weights(filename);
+    return model;
 }
 
+template<typename T, typename Storage>
+template<typename U>
+void Perceptrone<T, Storage>::read_parameters(std::istream& file) {
+    parameterId.renew();
+    const std::vector<size_t>& sizes = topology->sizes;
+    std::vector<U> row;
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        row.resize(sizes[i + 1]);
+        for (size_t j = 0; j < sizes[i]; ++j) {
+            file.read(reinterpret_cast<char*>(row.data()), row.size() * sizeof(U));
+            for (size_t k = 0; k < sizes[i + 1]; ++k) {
+                weight(i, j, k) = static_cast<T>(row[k]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        row.resize(sizes[i]);
+        file.read(reinterpret_cast<char*>(row.data()), row.size() * sizeof(U));
+        Storage* layer = bias_data(i);
+        for (size_t k = 0; k < sizes[i]; ++k) {
+            layer[k] = static_cast<T>(row[k]);
+        }
+    }
+}
 
 template class Perceptrone<float>;
-template class Perceptrone<double>;
\ No newline at end of file
+template class Perceptrone<double>;
+template class Perceptrone<float, float16>;
+template class Perceptrone<float, bfloat16>;
\ No newline at end of file
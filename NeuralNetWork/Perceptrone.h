@@ -2,40 +2,337 @@
 #include <string>
 #include <stdexcept>
 #include <fstream>
-#include <random>
 #include <cmath>
-#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include "mlpActivators.hpp"
+#include "alignedAllocator.hpp"
+#include "simdKernels.h"
+#include "span.hpp"
+#include "threadPool.h"
+#include "modelFile.h"
+#include "randomStream.h"
 #pragma once
 
+// Read-only view of one weight layer. Rows are output neurons, each row holding
+// the neuron's incoming weights contiguously; rows are padded to `stride`.
 template<typename T>
+struct LayerView {
+    const T* data;
+    size_t inputs;
+    size_t outputs;
+    size_t stride;
+
+    const T* row(size_t neuron) const { return data + neuron * stride; }
+    const T& operator()(size_t prev_neuron, size_t neuron) const {
+        return data[neuron * stride + prev_neuron];
+    }
+};
+
+// Kernels for one layer of a forward pass: an instruction set, and whether to split
+// the layer across the thread pool. tune_kernels (kernelTuner.h) picks them per host.
+struct LayerKernelChoice {
+    SimdIsa isa = SimdIsa::SCALAR;
+    bool threaded = false;
+};
+
+// T is the type of inputs, outputs and arithmetic. Storage is the type weights and
+// biases are held in: T, or float16 / bfloat16 with T = float to halve the memory
+// and bandwidth per model. The kernels widen Storage to T as they load it; the
+// public API always reads and writes T.
+template<typename T, typename Storage = T>
 class Perceptrone {
+public:
+    // What a model's parameters do not change: layer sizes, activations, and where
+    // each layer sits in the parameter and activation buffers. Built once by the
+    // constructor and shared, immutable, by every copy of the model and by its
+    // workspaces, so a copy allocates and copies only the parameters.
+    struct Topology {
+        std::vector<size_t> sizes;
+        std::vector<typename Activator<T>::Function> activations;
+        // Offsets into the parameters of weight layer l (feeding layer l + 1) and of
+        // the biases of layer l, each aligned to MLP_ALIGNMENT.
+        std::vector<size_t> weightOffset;
+        std::vector<size_t> biasOffset;
+        size_t parameterCount = 0;
+        // Offset of layer l in a workspace, padded_size<T>(sizes[l]) values; the last
+        // entry is the total.
+        std::vector<size_t> activationOffset;
+    };
+
+    // Activation buffers for forward passes. The const predict overloads only read
+    // the model, so threads can share one Perceptrone with one Workspace each. They
+    // throw std::invalid_argument for a Workspace made for other layer sizes or a
+    // default-constructed one.
+    class Workspace {
+    public:
+        Workspace() = default;
+        explicit Workspace(const Perceptrone& model);
+
+        // Activations of `layer` from the last single-input pass, zero padded.
+        const T* layer(size_t layer) const { return data.data() + topology->activationOffset[layer]; }
+        T* layer(size_t layer) { return data.data() + topology->activationOffset[layer]; }
+
+    private:
+        friend class Perceptrone;
+
+        // Layer l of a batch: batchRows rows of padded_size(sizes[l]) values.
+        T* batch_layer(size_t layer) { return batchData.data() + batchRows * topology->activationOffset[layer]; }
+
+        std::shared_ptr<const Topology> topology;
+        // Every layer, at topology->activationOffset; padding stays zero.
+        AlignedVector<T> data;
+        AlignedVector<T> batchData;
+        size_t batchRows = 0;
+    };
+
+    // State of incremental passes (predict_incremental) with one model. Holds the
+    // first layer's outputs before activation and a copy of its weights stored
+    // input-major, so that a pass only applies the columns of the inputs that changed
+    // since the previous one. Used with another model of the same sizes, or after the
+    // model's parameters change, the next pass copies the weights again and
+    // recomputes the first layer in full.
+    class IncrementalState {
+    public:
+        IncrementalState() = default;
+        // Every refresh_interval-th pass, and the first, recomputes the first layer in
+        // full, which bounds the rounding drift of the updates.
+        explicit IncrementalState(const Perceptrone& model, size_t refresh_interval = 64);
+
+    private:
+        friend class Perceptrone;
+
+        // ws.data[0] holds the input of the previous pass.
+        Workspace ws;
+        // columns[i * padded_size<T>(sizes[1]) ...] are the weights from input i, zero padded.
+        AlignedVector<Storage> columns;
+        AlignedVector<T> preactivation;
+        size_t refreshInterval = 0;
+        size_t sinceRefresh = 0;
+        // ParameterId of the model `columns` were copied from.
+        uint64_t parameters = 0;
+
+        void copy_columns(const Perceptrone& model);
+    };
+
 protected:
-    std::vector<std::vector<T>> bias;
-    std::vector<std::vector<std::vector<T>>> weights;
-    std::vector<std::vector<T>> data;
-    std::vector<std::function<T(T)>> activations;
-    std::vector<std::function<T(T)>> activationDerivatives;
+    std::shared_ptr<const Topology> topology;
+    // Weights and biases of every layer in one buffer, at the topology's offsets.
+    // Weight layer l is a sizes[l + 1] x padded_size<T>(sizes[l]) matrix, zero padded.
+    AlignedVector<Storage> parameterValues;
+    typename Activator<T>::Parameters activationParameters;
+    const SimdKernels<T, Storage>* kernels;
+    // Set by set_kernel_plan, one entry per weight layer; empty when every layer runs
+    // `kernels` and threads by the parallelWork threshold.
+    std::vector<LayerKernelChoice> kernelPlan;
+    std::vector<const SimdKernels<T, Storage>*> planKernels;
+    // Used by the non-const predict overloads through own_workspace(). Not copied, so
+    // copying a model allocates only its parameters; a copy makes its own on first use.
+    struct OwnWorkspace {
+        Workspace ws;
+
+        OwnWorkspace() = default;
+        OwnWorkspace(const OwnWorkspace&) {}
+        OwnWorkspace(OwnWorkspace&&) = default;
+        OwnWorkspace& operator=(const OwnWorkspace&) { ws = Workspace(); return *this; }
+        OwnWorkspace& operator=(OwnWorkspace&&) = default;
+    };
+    OwnWorkspace workspace;
+    // Names the current parameter values. A new one is drawn by every constructor,
+    // copy, assignment and change of the parameters, so an IncrementalState can tell
+    // whether the weights it copied are still the model's. Derived classes that
+    // write the parameters call renew().
+    struct ParameterId {
+        uint64_t value = next();
+
+        ParameterId() = default;
+        ParameterId(const ParameterId&) {}
+        ParameterId& operator=(const ParameterId&) { value = next(); return *this; }
+        void renew() { value = next(); }
+
+    private:
+        static uint64_t next() {
+            static std::atomic<uint64_t> counter{0};
+            return ++counter;
+        }
+    };
+    ParameterId parameterId;
+    // Not owned; nullptr keeps every layer on the calling thread.
+    ThreadPool* threadPool = nullptr;
+    size_t parallelWork = 0;
+
+    void check_workspace(const Workspace& ws) const;
+    // Computes layers begin .. end - 1 from ws.layer(begin - 1); through the last by default.
+    void calculate(Workspace& ws, size_t begin = 1, size_t end = 0) const;
+    void calculate_batch(Workspace& ws, size_t rows) const;
+    // Calls f(first, count) over ranges of a layer's outputs, on the thread pool if
+    // there is one and `parallel` is set.
+    template<typename F>
+    void for_output_ranges(size_t outputs, bool parallel, F&& f) const;
+    // Kernels of weight layer `layer` and whether a single-input pass splits it.
+    const SimdKernels<T, Storage>& layer_kernels(size_t layer) const {
+        return planKernels.empty() ? *kernels : *planKernels[layer];
+    }
+    bool parallel_layer(size_t layer) const {
+        return kernelPlan.empty() ? topology->sizes[layer + 1] * stride(layer) >= parallelWork : kernelPlan[layer].threaded;
+    }
+    // Reads the weights and biases that follow the header of a weights file, stored as U.
+    template<typename U>
+    void read_parameters(std::istream& file);
+    // Reads the payload of a model file whose values are stored as U; returns its CRC.
+    template<typename U>
+    uint32_t read_model_payload(std::istream& file);
 
-    static T random_float(T min, T max);
-    void calculate();
+    static std::shared_ptr<const Topology> make_topology(const std::vector<size_t>& sizes,
+        const std::vector<typename Activator<T>::Function>& activations);
+
+    size_t stride(size_t layer) const { return padded_size<T>(topology->sizes[layer]); }
+    const Storage* weight_data(size_t layer) const { return parameterValues.data() + topology->weightOffset[layer]; }
+    Storage* weight_data(size_t layer) { return parameterValues.data() + topology->weightOffset[layer]; }
+    const Storage* bias_data(size_t layer) const { return parameterValues.data() + topology->biasOffset[layer]; }
+    Storage* bias_data(size_t layer) { return parameterValues.data() + topology->biasOffset[layer]; }
+    Storage& weight(size_t layer, size_t prev_neuron, size_t neuron) {
+        return weight_data(layer)[neuron * stride(layer) + prev_neuron];
+    }
+    Workspace& own_workspace() {
+        if (workspace.ws.topology != topology) workspace.ws = Workspace(*this);
+        return workspace.ws;
+    }
+
+    // Allocates the parameters, all zero, without drawing them, for the loaders that
+    // overwrite every one; the public constructor randomizes after this.
+    struct Unset {};
+    Perceptrone(Unset, const std::vector<size_t>& neurons,
+        const std::vector<typename Activator<T>::Function>& activate,
+        const typename Activator<T>::Parameters& parameters);
 
 public:
     Perceptrone(const std::vector<size_t>& neurons,
         const std::vector<typename Activator<T>::Function>& activate,
-        T maxBiasValue);
+        T maxBiasValue,
+        const typename Activator<T>::Parameters& parameters = {});
+
+    Workspace make_workspace() const { return Workspace(*this); }
 
     std::vector<T> predict(const std::vector<T>& input);
-   
-    const std::vector<std::vector<std::vector<T>>>& get_weights() const;
-    const std::vector<std::vector<T>>& get_biases() const;
-    
+    std::vector<T> predict(Workspace& ws, const std::vector<T>& input) const;
+
+    // Reads get_sizes().front() values from input and writes get_sizes().back()
+    // values to output. Allocates nothing, except that the first call without a
+    // Workspace on a model, or on a copy of one, makes the model's own.
+    void predict_into(const T* input, T* output);
+    void predict_into(Span<const T> input, Span<T> output);
+    void predict_into(Workspace& ws, const T* input, T* output) const;
+    void predict_into(Workspace& ws, Span<const T> input, Span<T> output) const;
+
+    // Output heads: the last layer is reduced inside its kernel rather than written
+    // out and scanned. predict_argmax returns the index of the largest output, the
+    // first of equal ones. predict_top_k writes the indices of the k largest outputs,
+    // largest first, and their values unless `values` is nullptr; it throws
+    // std::invalid_argument unless 1 <= k <= the output size. predict_softmax
+    // writes the softmax of the outputs. The last layer stays on the calling thread.
+    size_t predict_argmax(const T* input);
+    size_t predict_argmax(Workspace& ws, const T* input) const;
+    void predict_top_k(const T* input, size_t k, size_t* indices, T* values = nullptr);
+    void predict_top_k(Workspace& ws, const T* input, size_t k, size_t* indices, T* values = nullptr) const;
+    void predict_softmax(const T* input, T* output);
+    void predict_softmax(Workspace& ws, const T* input, T* output) const;
+
+    // Same outputs as predict_into up to rounding: the first layer is updated by
+    // W[:, i] * (input[i] - previous[i]) for each input that differs from the previous
+    // pass on `state`, so it costs O(changed x sizes[1]) instead of O(inputs x
+    // sizes[1]). Passes where more than half of the inputs changed, or any changed
+    // input is not finite, recompute it in full.
+    IncrementalState make_incremental_state(size_t refresh_interval = 64) const {
+        return IncrementalState(*this, refresh_interval);
+    }
+    void predict_incremental(IncrementalState& state, const T* input, T* output) const;
+
+    // Runs `rows` row-major input vectors of `cols` values each and writes
+    // rows x output-size values to `output`.
+    void predict_batch(const T* input, size_t rows, size_t cols, T* output);
+    std::vector<T> predict_batch(const std::vector<T>& input, size_t rows);
+    void predict_batch(Workspace& ws, const T* input, size_t rows, size_t cols, T* output) const;
+
+    // Pins this model to the kernels of one instruction set (lowered to what the CPU
+    // supports), dropping any kernel plan.
+    void set_simd_isa(SimdIsa isa) {
+        kernels = &simd_kernels<T, Storage>(isa);
+        set_kernel_plan({});
+    }
+    SimdIsa get_simd_isa() const { return kernels->isa; }
+
+    // Runs weight layer l (feeding layer l + 1) with the instruction set of plan[l],
+    // and splits it across the thread pool in single-input passes exactly when
+    // plan[l].threaded; batches keep the set_thread_pool threshold. Backpropagation
+    // keeps the set_simd_isa kernels. An empty plan restores the defaults.
+    void set_kernel_plan(const std::vector<LayerKernelChoice>& plan);
+    // What each layer runs with in single-input passes: the plan if one is set,
+    // otherwise the defaults spelled out.
+    std::vector<LayerKernelChoice> get_kernel_plan() const;
+
+    // EXACT by default; FAST and TABLE trade a bounded error (fastActivations.hpp) for
+    // cheaper transcendental activations. Not stored in model files.
+    void set_activation_accuracy(typename Activator<T>::Accuracy accuracy) {
+        activationParameters.accuracy = accuracy;
+    }
+
+    // Splits the outputs of every layer with at least `min_layer_work` multiply-adds per
+    // pass (rows x weights for batches) across `pool`; smaller layers stay on the calling
+    // thread, where waking workers would cost more than it saves. Results do not
+    // change. The pool is shared, not owned: it must outlive this model and its copies.
+    // nullptr turns threading off.
+    void set_thread_pool(ThreadPool* pool, size_t min_layer_work = size_t(1) << 19) {
+        threadPool = pool;
+        parallelWork = min_layer_work;
+    }
+
+    // Redraws every weight uniformly from +-sqrt(2 / inputs) and every bias from
+    // +-maxBiasValue. The constructor does this with next_random_stream(); the values
+    // depend only on `rng` and the topology.
+    void randomize(const RandomStream& rng, T maxBiasValue);
+    // Adds N(0, sigma) noise to each weight and bias with probability `rate`, drawn
+    // from substreams of `rng`, one per bias and weight layer.
+    void perturb(const RandomStream& rng, T rate, T sigma);
+
+    const std::vector<size_t>& get_sizes() const { return topology->sizes; }
+    const std::vector<typename Activator<T>::Function>& get_activations() const { return topology->activations; }
+    const typename Activator<T>::Parameters& get_activation_parameters() const { return activationParameters; }
+    LayerView<Storage> layer_weights(size_t layer) const;
+
+    // Nested copy indexed [layer][prev_neuron][neuron], as used by the weights file.
+    std::vector<std::vector<std::vector<T>>> get_weights() const;
+    std::vector<std::vector<T>> get_biases() const;
+
     void set_weights(const std::vector<std::vector<std::vector<T>>>& new_weights);
     void set_biases(const std::vector<std::vector<T>>& new_biases);
-    
+
+    // Values are written as Storage. load_weights also accepts a file of T values,
+    // so a 16-bit model can load weights saved by a float one. It throws
+    // std::runtime_error if the file is shorter or longer than the network needs.
     void save_weights(const std::string& filename) const;
     void load_weights(const std::string& filename);
+
+    // Self-describing model file (see modelFile.h): topology, activations, their
+    // parameters and value types are in the header, so loading needs none of them.
+    // Written to filename + ".tmp" and renamed over `filename`, so a reader never
+    // sees a partial file and a mapping of the previous one (MappedPerceptrone)
+    // stays valid.
+    void save(const std::string& filename) const;
+    // Throws std::runtime_error if the file is damaged or holds a different T. A file
+    // stored as T also loads into a 16-bit model, as with load_weights.
+    static Perceptrone from_file(const std::string& filename);
+    // Reads a save_weights file, whose header holds only the layer sizes; the rest of
+    // the description has to be supplied. from_legacy_file(...).save(...) converts one.
+    // Neither draws from next_random_stream(), so loading models leaves the streams
+    // later models and populations get unchanged.
+    static Perceptrone from_legacy_file(const std::string& filename,
+        const std::vector<typename Activator<T>::Function>& activate,
+        const typename Activator<T>::Parameters& parameters = {});
 };
 
 extern template class Perceptrone<float>;
-extern template class Perceptrone<double>;
\ No newline at end of file
+extern template class Perceptrone<double>;
+extern template class Perceptrone<float, float16>;
+extern template class Perceptrone<float, bfloat16>;
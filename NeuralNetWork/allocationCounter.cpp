@@ -0,0 +1,58 @@
+#include "allocationCounter.h"
+
+#ifdef MLP_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<size_t> allocations{0};
+
+    void* counted_alloc(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+
+    void* counted_aligned_alloc(size_t size, std::align_val_t alignment) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        const size_t align = static_cast<size_t>(alignment);
+        const size_t rounded = (size + align - 1) / align * align;
+        if (void* p = std::aligned_alloc(align, rounded ? rounded : align)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+size_t AllocationCounter::total() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return counted_alloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return counted_alloc(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+#else
+
+size_t AllocationCounter::total() {
+    return 0;
+}
+
+#endif
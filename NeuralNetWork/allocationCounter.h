@@ -0,0 +1,28 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+// Counts calls to the global operator new. Only active in builds defining
+// MLP_COUNT_ALLOCATIONS (Debug builds); elsewhere enabled is false and counts stay 0.
+class AllocationCounter {
+public:
+#ifdef MLP_COUNT_ALLOCATIONS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    AllocationCounter() : start(total()) {}
+
+    // Allocations made since construction.
+    size_t count() const { return total() - start; }
+
+    // Allocations made since program start.
+    static size_t total();
+
+private:
+    size_t start;
+};
+
+#endif
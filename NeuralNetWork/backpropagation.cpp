@@ -13,55 +13,57 @@ template<typename T>
 std::vector<T> Backpropagation<T>::train(const std::vector<T>& input,
                    const std::vector<T>& target,
                    T learning_rate) {
-    if (input.size() != this->data[0].size()) {
+    const std::vector<size_t>& sizes = this->get_sizes();
+    if (input.size() != sizes.front()) {
         throw std::invalid_argument("Input size mismatch");
     }
-    if (target.size() != this->data.back().size()) {
+    if (target.size() != sizes.back()) {
         throw std::invalid_argument("Target size mismatch");
     }
+    this->parameterId.renew();
 
-    this->data[0] = input;
-    this->calculate();
+    auto& ws = this->own_workspace();
+    std::copy(input.begin(), input.end(), ws.layer(0));
+    this->calculate(ws);
 
-    std::vector<std::vector<T>> gradients(this->data.size());
-    for (size_t i = 0; i < this->data.size(); ++i) {
-        gradients[i].resize(this->data[i].size(), T(0));
+    // gradients[layer] is padded like the activations, for the kernels.
+    std::vector<AlignedVector<T>> gradients(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        gradients[i].assign(this->stride(i), T(0));
     }
 
-    for (size_t i = 0; i < this->data.back().size(); ++i) {
-        gradients.back()[i] = T(2) * (this->data.back()[i] - target[i]);
+    for (size_t i = 0; i < sizes.back(); ++i) {
+        gradients.back()[i] = T(2) * (ws.layer(sizes.size() - 1)[i] - target[i]);
     }
 
-    for (size_t layer = this->data.size() - 1; layer > 0; --layer) {
-        auto& derivative = this->activationDerivatives[layer - 1];
+    // Each layer's weights are read once: the kernel accumulates the gradient of the
+    // layer below from each row and updates the row while it is in cache. Updating
+    // layer - 1 here is safe, the layers below only need their own weights.
+    std::vector<T> derivative;
+    for (size_t layer = sizes.size() - 1; layer > 0; --layer) {
+        derivative.assign(ws.layer(layer), ws.layer(layer) + sizes[layer]);
+        Activator<T>::apply_derivative(this->get_activations()[layer - 1], derivative.data(),
+                                       derivative.size(), this->activationParameters);
 
-        for (size_t neuron = 0; neuron < this->data[layer].size(); ++neuron) {
-            T grad = gradients[layer][neuron] * derivative(this->data[layer][neuron]);
-            grad = std::max(T(-1.0), std::min(T(1.0), grad));
-            gradients[layer][neuron] = grad;
-
-            for (size_t prev_neuron = 0; prev_neuron < this->data[layer - 1].size(); ++prev_neuron) {
-                gradients[layer - 1][prev_neuron] += grad * this->weights[layer - 1][prev_neuron][neuron];
-            }
+        for (size_t neuron = 0; neuron < sizes[layer]; ++neuron) {
+            T grad = gradients[layer][neuron] * derivative[neuron];
+            gradients[layer][neuron] = std::max(T(-1.0), std::min(T(1.0), grad));
         }
-    }
 
-    for (size_t layer = 0; layer < this->weights.size(); ++layer) {
-        for (size_t j = 0; j < this->weights[layer].size(); ++j) {
-            for (size_t k = 0; k < this->weights[layer][j].size(); ++k) {
-                T delta = learning_rate * gradients[layer + 1][k] * this->data[layer][j];
-                this->weights[layer][j][k] -= delta;
-            }
-        }
+        T* below = layer > 1 ? gradients[layer - 1].data() : nullptr;
+        this->kernels->backward(this->weight_data(layer - 1), this->stride(layer - 1), sizes[layer],
+                                gradients[layer].data(), ws.layer(layer - 1), learning_rate, below);
     }
 
-    for (size_t layer = 1; layer < this->bias.size(); ++layer) {
-        for (size_t neuron = 0; neuron < this->bias[layer].size(); ++neuron) {
-            this->bias[layer][neuron] -= learning_rate * gradients[layer][neuron];
+    for (size_t layer = 1; layer < sizes.size(); ++layer) {
+        T* bias = this->bias_data(layer);
+        for (size_t neuron = 0; neuron < sizes[layer]; ++neuron) {
+            bias[neuron] -= learning_rate * gradients[layer][neuron];
         }
     }
 
-    return this->data.back();
+    const T* output = ws.layer(sizes.size() - 1);
+    return std::vector<T>(output, output + sizes.back());
 }
 
 template class Backpropagation<float>;
@@ -0,0 +1,632 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "allocationCounter.h"
+#include "backpropagation.h"
+#include "binaryPerceptrone.h"
+#include "exec_time.h"
+#include "mappedPerceptrone.h"
+#include "modelSnapshots.h"
+#include "neuronPruning.h"
+#include "quantizedPerceptrone.h"
+#include "snake_policy.h"
+#include "sparsePerceptrone.h"
+#include "staticPerceptrone.hpp"
+
+using namespace std;
+
+// Set by a benchmark whose results are wrong; main then exits non-zero.
+bool failed = false;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "ОШИБКА: %s\n", what);
+        failed = true;
+    }
+}
+
+// Runs `step` until at least `seconds` have passed and returns calls per second.
+template<typename F>
+double calls_per_second(F&& step, double seconds = 0.3) {
+    size_t calls = 0;
+    AppExecutionTimeCounter::StartMeasurement();
+    double elapsed = 0.0;
+    do {
+        step();
+        calls++;
+        elapsed = AppExecutionTimeCounter::EndMeasurement();
+    } while (elapsed < seconds);
+    return calls / elapsed;
+}
+
+// One hidden layer of `width` neurons between `width` inputs and `width` outputs,
+// i.e. two width x width matrices.
+void layer_width_benchmark() {
+    using T = float;
+    const size_t batch = 64;
+
+    printf("ГФЛОП/с по ширине слоя\n");
+    printf("Ширина  Прямой(1)  Прямой(%zu)  Обучение\n", batch);
+    for (size_t width : {64, 128, 256, 512, 1024, 2048, 4096}) {
+        Perceptrone<T> model({width, width, width},
+                             {Activator<T>::RELU, Activator<T>::IDENTITY}, T(0.1));
+        Backpropagation<T> trainer(model);
+
+        vector<T> input(batch * width), output(batch * width), target(width, T(0));
+        for (size_t i = 0; i < input.size(); i++) {
+            input[i] = T(i % 7) / T(7);
+        }
+        vector<T> sample(input.begin(), input.begin() + width);
+
+        // Multiply-adds per sample: forward 2 * w^2, training adds the backward product
+        // and the weight update for 3x that.
+        const double forward_flops = 2.0 * 2.0 * double(width) * double(width);
+
+        double single = calls_per_second([&] { model.predict_into(sample.data(), output.data()); });
+        double batched = calls_per_second([&] {
+            model.predict_batch(input.data(), batch, width, output.data());
+        }) * batch;
+        double train = calls_per_second([&] { trainer.train(sample, target, T(1e-6)); });
+
+        printf("%6zu  %9.2f  %10.2f  %8.2f\n", width,
+               single * forward_flops * 1e-9,
+               batched * forward_flops * 1e-9,
+               train * 3.0 * forward_flops * 1e-9);
+    }
+}
+
+// Single-input latency of a wide network against the number of threads splitting
+// each layer. Speedup is relative to the calling thread alone.
+void thread_scaling_benchmark() {
+    using T = float;
+    const size_t width = 2048;
+    Perceptrone<T> model({width, width, width, width},
+                         {Activator<T>::RELU, Activator<T>::RELU, Activator<T>::IDENTITY}, T(0.1));
+    vector<T> input(width, T(0.5)), output(width);
+
+    printf("Задержка прямого прохода по числу потоков (ширина %zu)\n", width);
+    printf("Потоков  мкс/вызов  Ускорение\n");
+    double base = 0.0;
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+        ThreadPool pool(threads);
+        model.set_thread_pool(&pool, 0);
+        double micros = 1e6 / calls_per_second([&] { model.predict_into(input.data(), output.data()); });
+        if (threads == 1) base = micros;
+        printf("%7zu  %9.1f  %9.2f\n", threads, micros, base / micros);
+    }
+    model.set_thread_pool(nullptr);
+}
+
+// Time from a weights file on disk to the first prediction: reading save_weights'
+// format into a Perceptrone against mapping a model file. Both files are
+// already in the page cache, so this is the cost of the loaders themselves.
+void load_time_benchmark() {
+    using T = float;
+    const size_t width = 2048;
+    const vector<size_t> sizes = {width, width, width, 10};
+    const vector<Activator<T>::Function> activations =
+        {Activator<T>::RELU, Activator<T>::RELU, Activator<T>::IDENTITY};
+    Perceptrone<T> model(sizes, activations, T(0.1));
+    model.save_weights("benchmark_weights.bin");
+    model.save("benchmark_weights.mlp");
+    vector<T> input(width, T(0.5)), output(10);
+
+    AppExecutionTimeCounter::StartMeasurement();
+    Perceptrone<T> loaded(sizes, activations, T(0.1));
+    loaded.load_weights("benchmark_weights.bin");
+    loaded.predict_into(input.data(), output.data());
+    double read_ms = AppExecutionTimeCounter::EndMeasurement() * 1e3;
+
+    AppExecutionTimeCounter::StartMeasurement();
+    MappedPerceptrone<T> mapped("benchmark_weights.mlp");
+    mapped.predict_into(input.data(), output.data());
+    double map_ms = AppExecutionTimeCounter::EndMeasurement() * 1e3;
+
+    printf("Загрузка и первый вызов (ширина %zu): чтение %.2f мс, отображение %.2f мс\n",
+           width, read_ms, map_ms);
+    remove("benchmark_weights.bin");
+    remove("benchmark_weights.mlp");
+}
+
+// Uniform and normal floats per second from one RandomStream against std::mt19937
+// with the standard distributions, as Perceptrone and Genetic used before.
+void random_benchmark() {
+    const size_t count = size_t(1) << 20;
+    vector<float> values(count);
+    RandomStream stream(1);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    const double per_call = double(count) / 1e6;
+    double philox_uniform = per_call * calls_per_second([&] { stream.fill_uniform(values.data(), count, -1.0f, 1.0f); });
+    double philox_normal = per_call * calls_per_second([&] { stream.fill_normal(values.data(), count, 0.0f, 1.0f); });
+    double mt_uniform = per_call * calls_per_second([&] { for (auto& v : values) v = uniform(gen); });
+    double mt_normal = per_call * calls_per_second([&] { for (auto& v : values) v = normal(gen); });
+
+    printf("Случайные числа (млн/с, %s): равномерные %.0f против %.0f, нормальные %.0f против %.0f\n",
+           simd_isa_name(random_kernels().isa), philox_uniform, mt_uniform, philox_normal, mt_normal);
+}
+
+// Elements per second and largest absolute error of each transcendental activation
+// at every accuracy, through the dispatched kernel epilogue. Errors are against
+// EXACT over x in [-20, 20]. Every accuracy must return NaN for a NaN input.
+void activation_benchmark() {
+    using A = Activator<float>;
+    const auto& kernels = simd_kernels<float>();
+    const size_t count = 4096, probes = size_t(1) << 20;
+    vector<float> values(count), grid(probes), exact(probes), approx(probes);
+    for (size_t i = 0; i < count; i++) values[i] = -8.0f + 16.0f * float(i) / float(count);
+    for (size_t i = 0; i < probes; i++) grid[i] = -20.0f + 40.0f * float(i) / float(probes - 1);
+
+    printf("Активации (млн/с, ошибка)  EXACT            FAST             TABLE\n");
+    for (A::Function f : {A::SIGMOID, A::TANH, A::SWISH, A::ELU, A::GELU, A::SELU, A::SOFTPLUS}) {
+        printf("%-26s", A::name(f));
+        A::Parameters p;
+        exact = grid;
+        kernels.activate(exact.data(), probes, f, p);
+        for (A::Accuracy accuracy : {A::EXACT, A::FAST, A::TABLE}) {
+            p.accuracy = accuracy;
+            vector<float> work = values;
+            double rate = double(count) / 1e6 * calls_per_second([&] {
+                work = values;
+                kernels.activate(work.data(), count, f, p);
+            }, 0.1);
+            approx = grid;
+            kernels.activate(approx.data(), probes, f, p);
+            double error = 0.0;
+            for (size_t i = 0; i < probes; i++) {
+                error = max(error, double(fabs(approx[i] - exact[i])));
+            }
+            printf("  %6.0f  %7.1e", rate, error);
+            float nan = NAN;
+            kernels.activate(&nan, 1, f, p);
+            check(std::isnan(nan), "Активация не сохраняет NaN");
+        }
+        printf("\n");
+    }
+}
+
+// Whether `call` throws std::invalid_argument both for a workspace made by `other`
+// and for a default-constructed one.
+template<typename Model, typename Call>
+bool rejects_workspaces(const Model& other, Call&& call) {
+    for (int kind = 0; kind < 2; kind++) {
+        typename Model::Workspace ws = kind == 0 ? other.make_workspace() : typename Model::Workspace();
+        try {
+            call(ws);
+            return false;
+        } catch (const invalid_argument&) {}
+    }
+    return true;
+}
+
+// A Workspace of another model, or a default-constructed one, must be rejected by
+// every const overload that takes one, on each kind of model, instead of overrunning
+// its buffers, and so must a top-k of 0 or more than the outputs.
+void workspace_check() {
+    using T = float;
+    const Perceptrone<T> model({8, 512, 4}, {Activator<T>::RELU, Activator<T>::IDENTITY}, 0.1f);
+    const Perceptrone<T> other({8, 64, 4}, {Activator<T>::RELU, Activator<T>::IDENTITY}, 0.1f);
+    vector<T> input(8, T(0.5)), output(4);
+    size_t rejected = 0, calls = 0;
+    auto expect_rejected = [&](const auto& other, auto&& call) {
+        rejected += rejects_workspaces(other, call);
+        calls++;
+    };
+    expect_rejected(other, [&](auto& ws) { model.predict_into(ws, input.data(), output.data()); });
+    expect_rejected(other, [&](auto& ws) { model.predict_batch(ws, input.data(), 1, input.size(), output.data()); });
+    expect_rejected(other, [&](auto& ws) { model.predict_argmax(ws, input.data()); });
+    expect_rejected(other, [&](auto& ws) { size_t index; model.predict_top_k(ws, input.data(), 1, &index); });
+    expect_rejected(other, [&](auto& ws) { model.predict_softmax(ws, input.data(), output.data()); });
+
+    const QuantizedPerceptrone quantized(model), quantized_other(other);
+    expect_rejected(quantized_other, [&](auto& ws) { quantized.predict_into(ws, input.data(), output.data()); });
+    const SparsePerceptrone<T> sparse(model), sparse_other(other);
+    expect_rejected(sparse_other, [&](auto& ws) { sparse.predict_into(ws, input.data(), output.data()); });
+    model.save("benchmark_workspace.mlp");
+    other.save("benchmark_workspace_other.mlp");
+    const MappedPerceptrone<T> mapped("benchmark_workspace.mlp"), mapped_other("benchmark_workspace_other.mlp");
+    remove("benchmark_workspace.mlp");
+    remove("benchmark_workspace_other.mlp");
+    expect_rejected(mapped_other, [&](auto& ws) { mapped.predict_into(ws, input.data(), output.data()); });
+    expect_rejected(mapped_other, [&](auto& ws) { mapped.predict_batch(ws, input.data(), 1, input.size(), output.data()); });
+    const BinaryPerceptrone binary(model), binary_other(other);
+    expect_rejected(binary_other, [&](auto& ws) { binary.predict_into(ws, input.data(), output.data()); });
+    expect_rejected(binary_other, [&](auto& ws) { binary.predict_argmax(ws, input.data()); });
+    // k must be between 1 and the number of outputs.
+    auto ws = model.make_workspace();
+    size_t indices[5];
+    for (size_t k : {size_t(0), size_t(5)}) {
+        try {
+            model.predict_top_k(ws, input.data(), k, indices);
+        } catch (const invalid_argument&) {
+            rejected++;
+        }
+        calls++;
+    }
+    printf("Неверные аргументы отклонены: %zu из %zu вызовов\n", rejected, calls);
+    check(rejected == calls, "Принят чужой Workspace или неверное k");
+}
+
+// The snake policy as a StaticPerceptrone read from its model file against
+// Perceptrone: time per prediction, and the largest output difference, which only
+// comes from the different order of the additions and must stay within rounding.
+void static_model_benchmark() {
+    using T = float;
+    using A = Activator<T>;
+    using SnakePolicy = StaticPerceptrone<T, Activations<T, A::RELU, A::RELU, A::RELU, A::IDENTITY>, 8, 64, 64, 64, 4>;
+    const size_t samples = 1024;
+    Perceptrone<T> model = Perceptrone<T>::from_file(SNAKE_POLICY_FILE);
+    const auto fixed = make_unique<SnakePolicy>(SnakePolicy::from_file(SNAKE_POLICY_FILE));
+    vector<T> inputs(samples * SnakePolicy::inputs);
+    RandomStream(1).fill_uniform(inputs.data(), inputs.size(), -1.0f, 1.0f);
+    T compiled[SnakePolicy::outputs], runtime[SnakePolicy::outputs];
+
+    double error = 0.0, scale = 0.0;
+    for (size_t i = 0; i < samples; i++) {
+        const T* x = inputs.data() + i * SnakePolicy::inputs;
+        fixed->predict(x, compiled);
+        model.predict_into(x, runtime);
+        for (size_t o = 0; o < SnakePolicy::outputs; o++) {
+            error = max(error, double(fabs(compiled[o] - runtime[o])));
+            scale = max(scale, double(fabs(runtime[o])));
+        }
+    }
+
+    size_t next = 0;
+    auto sample = [&] { return inputs.data() + (next++ % samples) * SnakePolicy::inputs; };
+    const double fixed_ns = 1e9 / calls_per_second([&] { fixed->predict(sample(), compiled); });
+    const double runtime_ns = 1e9 / calls_per_second([&] { model.predict_into(sample(), runtime); });
+
+    printf("StaticPerceptrone змейки: %.0f нс против %.0f нс, расхождение до %.1e\n", fixed_ns, runtime_ns, error);
+    check(error <= 1e-5 * max(scale, 1.0), "StaticPerceptrone расходится с Perceptrone на модели змейки");
+}
+
+// The snake policy compiled in by MLPCodegen against Perceptrone running the same
+// model file: time per prediction, and every output must be bit-equal to the
+// runtime's. AVX2 and AVX512 round alike, as do SCALAR and SSE2 (simdKernels.h), so
+// the timed kernels are the ones checked whenever they fuse multiply-adds as the
+// header does; otherwise, e.g. with MLP_ISA pinned to SSE2, the matching group is.
+void generated_model_benchmark() {
+    using T = float;
+    const size_t samples = 1024;
+    Perceptrone<T> model = Perceptrone<T>::from_file(SNAKE_POLICY_FILE);
+    vector<T> inputs(samples * snake_policy::inputs);
+    RandomStream(1).fill_uniform(inputs.data(), inputs.size(), -1.0f, 1.0f);
+    T generated[snake_policy::outputs], runtime[snake_policy::outputs];
+
+    const bool selected_fuses = selected_simd_isa() >= SimdIsa::AVX2;
+    if (selected_fuses != generated_model::fused_multiply_add) {
+        model.set_simd_isa(generated_model::fused_multiply_add ? SimdIsa::AVX2 : SimdIsa::SSE2);
+    }
+    const char* matching = simd_isa_name(model.get_simd_isa());
+    size_t equal = 0;
+    for (size_t i = 0; i < samples; i++) {
+        const T* x = inputs.data() + i * snake_policy::inputs;
+        snake_policy::predict(x, generated);
+        model.predict_into(x, runtime);
+        equal += memcmp(generated, runtime, sizeof(generated)) == 0;
+    }
+    model.set_simd_isa(selected_simd_isa());
+
+    size_t next = 0;
+    auto sample = [&] { return inputs.data() + (next++ % samples) * snake_policy::inputs; };
+    const double generated_ns = 1e9 / calls_per_second([&] { snake_policy::predict(sample(), generated); });
+    const double runtime_ns = 1e9 / calls_per_second([&] { model.predict_into(sample(), runtime); });
+
+    printf("Сгенерированная модель змейки: %.0f нс против %.0f нс (%s), совпадает с %s: %zu из %zu\n",
+           generated_ns, runtime_ns, simd_isa_name(model.get_simd_isa()), matching, equal, samples);
+    check(equal == samples, "Сгенерированная модель змейки не совпадает с Perceptrone");
+}
+
+// The snake policy and a wider model of the given sizes, with ReLU hidden layers and
+// an identity output, for the benchmarks that compare the two.
+vector<Perceptrone<float>> snake_and_wide_models(const vector<size_t>& wide) {
+    vector<Activator<float>::Function> activations(wide.size() - 2, Activator<float>::RELU);
+    activations.push_back(Activator<float>::IDENTITY);
+    vector<Perceptrone<float>> models;
+    models.push_back(Perceptrone<float>::from_file(SNAKE_POLICY_FILE));
+    models.emplace_back(wide, activations, 0.1f);
+    return models;
+}
+
+// Action choice as the snake loop made it, copying out the outputs and scanning
+// them, against the argmax head, on the snake policy and on a 1000-way classifier.
+void output_head_benchmark() {
+    using T = float;
+    const size_t samples = 256;
+    vector<Perceptrone<T>> models = snake_and_wide_models({64, 256, 1000});
+    for (Perceptrone<T>& model : models) {
+        const vector<size_t>& sizes = model.get_sizes();
+        vector<T> inputs(samples * sizes.front()), output(sizes.back());
+        RandomStream(2).fill_uniform(inputs.data(), inputs.size(), -1.0f, 1.0f);
+        size_t next = 0, agree = 0;
+        auto sample = [&] { return inputs.data() + (next++ % samples) * sizes.front(); };
+        auto scan = [&](const T* x) {
+            model.predict_into(x, output.data());
+            return size_t(max_element(output.begin(), output.end()) - output.begin());
+        };
+        for (size_t i = 0; i < samples; i++) {
+            agree += scan(inputs.data() + i * sizes.front()) == model.predict_argmax(inputs.data() + i * sizes.front());
+        }
+        volatile size_t action = 0;
+        const double scan_ns = 1e9 / calls_per_second([&] { action = scan(sample()); });
+        const double head_ns = 1e9 / calls_per_second([&] { action = model.predict_argmax(sample()); });
+        printf("Выбор действия, %zu выходов: %.0f нс с копированием и поиском, %.0f нс в ядре, "
+               "совпадает %zu из %zu\n", sizes.back(), scan_ns, head_ns, agree, samples);
+    }
+}
+
+// Full passes against incremental ones when `changed` inputs move per step: the
+// snake policy with two of its eight features, and a wide sensor model with 1%.
+void incremental_benchmark() {
+    using T = float;
+    struct Case { Perceptrone<T> model; size_t changed; };
+    vector<Case> cases;
+    cases.push_back({Perceptrone<T>::from_file(SNAKE_POLICY_FILE), 2});
+    cases.push_back({Perceptrone<T>({1024, 256, 256, 16},
+                                    {Activator<T>::RELU, Activator<T>::RELU, Activator<T>::IDENTITY}, 0.1f), 10});
+    for (Case& c : cases) {
+        const size_t inputs = c.model.get_sizes().front();
+        const size_t outputs = c.model.get_sizes().back();
+        const size_t steps = 4096;
+        // Each step copies the previous input and moves `changed` random features.
+        vector<T> sequence(steps * inputs), full(outputs), incremental(outputs);
+        RandomStream rng(3);
+        rng.fill_uniform(sequence.data(), inputs, -1.0f, 1.0f);
+        vector<uint32_t> picks(c.changed);
+        vector<T> values(c.changed);
+        for (size_t s = 1; s < steps; s++) {
+            copy(sequence.begin() + (s - 1) * inputs, sequence.begin() + s * inputs, sequence.begin() + s * inputs);
+            rng.fill_u32(picks.data(), picks.size());
+            rng.fill_uniform(values.data(), values.size(), -1.0f, 1.0f);
+            for (size_t k = 0; k < c.changed; k++) sequence[s * inputs + picks[k] % inputs] = values[k];
+        }
+
+        auto state = c.model.make_incremental_state();
+        double error = 0.0;
+        for (size_t s = 0; s < steps; s++) {
+            c.model.predict_into(sequence.data() + s * inputs, full.data());
+            c.model.predict_incremental(state, sequence.data() + s * inputs, incremental.data());
+            for (size_t o = 0; o < outputs; o++) error = max(error, double(fabs(full[o] - incremental[o])));
+        }
+        // A state kept across a change of the weights must not use the old ones, even
+        // for the input it saw last, which would change nothing.
+        const T* last = sequence.data() + (steps - 1) * inputs;
+        Perceptrone<T> changed = c.model;
+        changed.perturb(RandomStream(4), T(1), T(0.1));
+        changed.predict_into(last, full.data());
+        changed.predict_incremental(state, last, incremental.data());
+        double stale = 0.0;
+        for (size_t o = 0; o < outputs; o++) stale = max(stale, double(fabs(full[o] - incremental[o])));
+        check(stale <= 1e-4, "Инкрементальный проход использовал веса прежней модели");
+
+        size_t next = 0;
+        auto sample = [&] { return sequence.data() + (next++ % steps) * inputs; };
+        const double full_ns = 1e9 / calls_per_second([&] { c.model.predict_into(sample(), full.data()); });
+        next = 0;
+        state = c.model.make_incremental_state();
+        const double incremental_ns = 1e9 / calls_per_second(
+            [&] { c.model.predict_incremental(state, sample(), incremental.data()); });
+        printf("Инкрементальный проход, %zu из %zu входов меняются: %.0f нс против %.0f нс, "
+               "расхождение до %.1e\n", c.changed, inputs, incremental_ns, full_ns, error);
+    }
+}
+
+// Evaluations per second of the float policy against its binarized version on each
+// popcount kernel, whose outputs must agree exactly, on the snake policy and on a
+// wider 256-1024-1024-16 model.
+void binary_benchmark() {
+    using T = float;
+    const size_t samples = 256;
+    vector<Perceptrone<T>> models = snake_and_wide_models({256, 1024, 1024, 16});
+    for (Perceptrone<T>& model : models) {
+        const vector<size_t>& sizes = model.get_sizes();
+        vector<T> inputs(samples * sizes.front());
+        RandomStream(4).fill_uniform(inputs.data(), inputs.size(), -1.0f, 1.0f);
+        BinaryPerceptrone binary(model);
+        const QuantizationReport report = binary.compare(model, inputs.data(), samples);
+
+        size_t next = 0;
+        volatile size_t action = 0;
+        auto sample = [&] { return inputs.data() + (next++ % samples) * sizes.front(); };
+        printf("Бинарная сеть %zu-%zu-...-%zu, %zu байт против %zu, выбор совпадает в %.0f%%: float %.0f нс",
+               sizes[0], sizes[1], sizes.back(), report.quantized_bytes, report.float_bytes,
+               report.argmax_agreement * 100.0, 1e9 / calls_per_second([&] { action = model.predict_argmax(sample()); }));
+
+        vector<T> reference(samples * sizes.back()), output(sizes.back());
+        for (SimdIsa isa : {SimdIsa::SCALAR, SimdIsa::AVX2, SimdIsa::AVX512}) {
+            binary.set_simd_isa(isa);
+            bool same = true;
+            for (size_t i = 0; i < samples; i++) {
+                T* y = isa == SimdIsa::SCALAR ? reference.data() + i * sizes.back() : output.data();
+                binary.predict_into(inputs.data() + i * sizes.front(), y);
+                same = same && memcmp(y, reference.data() + i * sizes.back(), sizes.back() * sizeof(T)) == 0;
+            }
+            const double ns = 1e9 / calls_per_second([&] { action = binary.predict_argmax(sample()); });
+            printf(", %s %.0f нс%s", binary.kernel_name(), ns, same ? "" : " (РАСХОЖДЕНИЕ)");
+            check(same, "Ядро бинарной сети расходится со скалярным");
+        }
+        printf("\n");
+    }
+}
+
+// Forward passes before and after removing neurons (prune_neurons) from the snake
+// policy and from a 64-512-512-16 model in which three quarters of the hidden ReLUs
+// never fire, as in an over-sized evolved policy. The outputs must stay within the
+// tolerance and those never-firing units must all be removed.
+void neuron_pruning_benchmark() {
+    using T = float;
+    const size_t samples = 4096;
+    const double tolerance = 1e-4;
+    vector<Perceptrone<T>> models = snake_and_wide_models({64, 512, 512, 16});
+    auto biases = models.back().get_biases();
+    for (size_t l = 1; l <= 2; l++) {
+        for (size_t n = 0; n < biases[l].size(); n++) {
+            if (n % 4 != 0) biases[l][n] = T(-100);
+        }
+    }
+    models.back().set_biases(biases);
+
+    for (Perceptrone<T>& model : models) {
+        const vector<size_t>& sizes = model.get_sizes();
+        vector<T> inputs(samples * sizes.front());
+        RandomStream(5).fill_uniform(inputs.data(), inputs.size(), -1.0f, 1.0f);
+        PrunedPerceptrone<T, T> pruned = prune_neurons(model, inputs.data(), samples, tolerance);
+        // The report's error is measured again here rather than trusted.
+        vector<T> output(sizes.back()), kept(sizes.back());
+        double error = 0.0;
+        for (size_t i = 0; i < samples; i++) {
+            model.predict_into(inputs.data() + i * sizes.front(), output.data());
+            pruned.model.predict_into(inputs.data() + i * sizes.front(), kept.data());
+            for (size_t o = 0; o < output.size(); o++) error = max(error, double(fabs(output[o] - kept[o])));
+        }
+        check(pruned.report.max_error <= tolerance && error <= tolerance,
+              "Удаление нейронов изменило выходы больше допуска");
+        if (&model == &models.back()) {
+            check(pruned.report.sizes_after == vector<size_t>{64, 128, 128, 16},
+                  "Из модели 64-512-512-16 не удалены неактивные нейроны");
+        }
+
+        size_t next = 0;
+        auto sample = [&] { return inputs.data() + (next++ % samples) * sizes.front(); };
+        const double before = 1e9 / calls_per_second([&] { model.predict_into(sample(), output.data()); });
+        const double after = 1e9 / calls_per_second([&] { pruned.model.predict_into(sample(), output.data()); });
+        printf("Удаление нейронов:");
+        for (size_t size : pruned.report.sizes_before) printf(" %zu", size);
+        printf(" ->");
+        for (size_t size : pruned.report.sizes_after) printf(" %zu", size);
+        printf(" (%zu постоянных, %zu с малым вкладом, ошибка %.1e): %.0f нс -> %.0f нс\n",
+               pruned.report.constant, pruned.report.low_contribution, pruned.report.max_error, before, after);
+    }
+}
+
+// Copies of the snake policy in a population of 1000, as made by building a new
+// population and by Genetic's selection, which assigns into the previous one: time
+// per model, and allocations per model in Debug builds.
+void population_copy_benchmark() {
+    using T = float;
+    const size_t population = 1000;
+    const Perceptrone<T> model = Perceptrone<T>::from_file(SNAKE_POLICY_FILE);
+    vector<Perceptrone<T>> generation(population, model);
+    vector<Perceptrone<T>> spare(generation);
+    auto pick = [&](size_t i) -> const Perceptrone<T>& { return generation[(i * 7919) % population]; };
+    auto build = [&] {
+        vector<Perceptrone<T>> next;
+        next.reserve(population);
+        for (size_t i = 0; i < population; i++) next.push_back(pick(i));
+    };
+    auto assign = [&] {
+        for (size_t i = 0; i < population; i++) spare[i] = pick(i);
+    };
+
+    const double build_ns = 1e9 / calls_per_second(build) / double(population);
+    const double assign_ns = 1e9 / calls_per_second(assign) / double(population);
+    printf("Копия модели змейки в популяции из %zu: новая %.0f нс, в готовую %.0f нс",
+           population, build_ns, assign_ns);
+    if (AllocationCounter::enabled) {
+        AllocationCounter built;
+        build();
+        const size_t build_allocations = built.count();
+        AllocationCounter assigned;
+        assign();
+        printf(", выделений памяти на модель %.1f и %.1f", double(build_allocations - 1) / double(population),
+               double(assigned.count()) / double(population));
+    }
+    printf("\n");
+}
+
+// The snake policy called directly, through a ModelSnapshots::Reader, and through one
+// while another thread publishes a new version every millisecond; then the time from
+// saving a retrained model to a Reader serving it, with a ModelFileWatcher polling the
+// file every 5 ms, and how far its outputs are from the retrained model's.
+void snapshot_benchmark() {
+    using T = float;
+    const Perceptrone<T> model = Perceptrone<T>::from_file(SNAKE_POLICY_FILE);
+    vector<T> input(model.get_sizes().front(), T(0.5)), output(model.get_sizes().back());
+    auto ws = model.make_workspace();
+    const double direct_ns = 1e9 / calls_per_second([&] { model.predict_into(ws, input.data(), output.data()); });
+
+    ModelSnapshots<Perceptrone<T>> snapshots(model);
+    ModelSnapshots<Perceptrone<T>>::Reader reader(snapshots);
+    const double reader_ns = 1e9 / calls_per_second([&] { reader.predict_into(input.data(), output.data()); });
+
+    atomic<bool> done{false};
+    thread trainer([&] {
+        Perceptrone<T> next = model;
+        for (uint64_t step = 0; !done; step++) {
+            next.perturb(RandomStream(step), T(0.01), T(0.01));
+            snapshots.publish(next);
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    const uint64_t first = reader.version();
+    const double publishing_ns = 1e9 / calls_per_second([&] { reader.predict_into(input.data(), output.data()); });
+    const uint64_t versions = reader.version() - first;
+    done = true;
+    trainer.join();
+    printf("Снимки модели змейки: напрямую %.0f нс, через Reader %.0f нс, "
+           "при публикации раз в 1 мс %.0f нс (%llu версий)\n",
+           direct_ns, reader_ns, publishing_ns, static_cast<unsigned long long>(versions));
+
+    const char* filename = "benchmark_snapshot.mlp";
+    model.save(filename);
+    ModelSnapshots<MappedPerceptrone<T>> served(ModelFileLoader<MappedPerceptrone<T>>::load(filename));
+    ModelSnapshots<MappedPerceptrone<T>>::Reader server(served);
+    {
+        ModelFileWatcher<MappedPerceptrone<T>> watcher(served, filename, chrono::milliseconds(5));
+        Perceptrone<T> retrained = model;
+        retrained.perturb(RandomStream(1), T(1), T(0.1));
+        vector<T> expected(output.size());
+        retrained.predict_into(input.data(), expected.data());
+
+        AppExecutionTimeCounter::StartMeasurement();
+        retrained.save(filename);
+        double reload_ms = 0.0;
+        do {
+            server.predict_into(input.data(), output.data());
+            this_thread::sleep_for(chrono::microseconds(100));
+            reload_ms = AppExecutionTimeCounter::EndMeasurement() * 1e3;
+        } while (server.version() == 1 && reload_ms < 2000.0);
+        double error = 0.0;
+        for (size_t o = 0; o < output.size(); o++) error = max(error, double(fabs(output[o] - expected[o])));
+        if (server.version() == 1) {
+            printf("Перезагрузка файла модели: новая версия не появилась за %.0f мс\n", reload_ms);
+        } else {
+            printf("Перезагрузка файла модели: версия %llu через %.1f мс, расхождение %.1e\n",
+                   static_cast<unsigned long long>(server.version()), reload_ms, error);
+        }
+        check(server.version() != 1, "Наблюдатель не загрузил сохранённую модель");
+        check(server.version() == 1 || error <= 1e-6, "Перезагруженная модель отвечает не как сохранённая");
+    }
+    remove(filename);
+}
+
+int main() {
+    printf("Матрично-векторные ядра: %s\n", simd_isa_name(simd_kernels<float>().isa));
+    layer_width_benchmark();
+    thread_scaling_benchmark();
+    load_time_benchmark();
+    random_benchmark();
+    activation_benchmark();
+    workspace_check();
+    static_model_benchmark();
+    generated_model_benchmark();
+    output_head_benchmark();
+    incremental_benchmark();
+    binary_benchmark();
+    neuron_pruning_benchmark();
+    population_copy_benchmark();
+    snapshot_benchmark();
+    return failed ? 1 : 0;
+}
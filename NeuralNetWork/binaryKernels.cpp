@@ -0,0 +1,73 @@
+#include "binaryKernels.h"
+
+namespace {
+
+// Bit count without a popcount instruction, which the baseline target lacks.
+int32_t popcount(uint64_t v) {
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return int32_t((v * 0x0101010101010101ull) >> 56);
+}
+
+void scalar_xor_popcount(const uint64_t* w, size_t words, size_t rows,
+                         const uint64_t* x, int32_t* count) {
+    for (size_t n = 0; n < rows; n++) {
+        count[n] = 0;
+    }
+    for (size_t k = 0; k < words; k++) {
+        const uint64_t* column = w + k * rows;
+        for (size_t n = 0; n < rows; n++) {
+            count[n] += popcount(column[n] ^ x[k]);
+        }
+    }
+}
+
+void scalar_xor_popcount_threshold(const uint64_t* w, size_t words, size_t rows,
+                                   const uint64_t* x, const int32_t* limit, uint64_t* y) {
+    int32_t count[64];
+    for (size_t start = 0; start < rows; start += 64) {
+        const size_t block = rows - start < 64 ? rows - start : 64;
+        for (size_t n = 0; n < block; n++) {
+            count[n] = 0;
+        }
+        for (size_t k = 0; k < words; k++) {
+            const uint64_t* column = w + k * rows + start;
+            for (size_t n = 0; n < block; n++) {
+                count[n] += popcount(column[n] ^ x[k]);
+            }
+        }
+        uint64_t bits = 0;
+        for (size_t n = 0; n < block; n++) {
+            bits |= uint64_t(count[n] <= limit[start + n]) << n;
+        }
+        y[start / 64] = bits;
+    }
+}
+
+constexpr BinaryKernels scalar_kernels = {"scalar", &scalar_xor_popcount, &scalar_xor_popcount_threshold};
+
+bool cpu_has_avx512vpopcntdq() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512vpopcntdq");
+#else
+    return false;
+#endif
+}
+
+}
+
+const BinaryKernels& binary_kernels(SimdIsa isa) {
+    if (isa > detect_simd_isa()) isa = detect_simd_isa();
+
+    const BinaryKernels* table = nullptr;
+    if (isa >= SimdIsa::AVX512 && cpu_has_avx512vpopcntdq()) table = binary_detail::avx512_kernels();
+    if (!table && isa >= SimdIsa::AVX2) table = binary_detail::avx2_kernels();
+    return table ? *table : scalar_kernels;
+}
+
+const BinaryKernels& binary_kernels() {
+    static const BinaryKernels& table = binary_kernels(selected_simd_isa());
+    return table;
+}
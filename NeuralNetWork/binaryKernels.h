@@ -0,0 +1,37 @@
+#ifndef BINARY_KERNELS_H
+#define BINARY_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "simdKernels.h"
+
+// Kernels of the binarized layers (binaryPerceptrone.h). Vectors of +-1 values are
+// packed 64 to a word, bit set for +1, with padding bits clear. A layer's weights are
+// stored word-major, word k of every row together, so each variant works on a block
+// of rows at once however short the rows are. All variants count exactly.
+struct BinaryKernels {
+    const char* name;
+
+    // count[n] = popcount(W[n] ^ x), the number of positions where row n and x differ,
+    // for n < rows. Word k of row n is w[k * rows + n]; rows is a multiple of
+    // MLP_ALIGNMENT / sizeof(uint64_t).
+    void (*xor_popcount)(const uint64_t* w, size_t words, size_t rows,
+                         const uint64_t* x, int32_t* count);
+
+    // The next layer's packed input: bit n of y is set when popcount(W[n] ^ x) <=
+    // limit[n], for n < rows. The rest of the last word written is cleared.
+    void (*xor_popcount_threshold)(const uint64_t* w, size_t words, size_t rows,
+                                   const uint64_t* x, const int32_t* limit, uint64_t* y);
+};
+
+// Best variant for selected_simd_isa(): avx512vpopcntdq, avx2 or scalar.
+const BinaryKernels& binary_kernels();
+const BinaryKernels& binary_kernels(SimdIsa isa);
+
+namespace binary_detail {
+    // Defined by the per-ISA translation units; nullptr when the ISA is not built.
+    const BinaryKernels* avx2_kernels();
+    const BinaryKernels* avx512_kernels();
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include "binaryKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("avx2")
+
+namespace {
+
+// Counts bits a byte at a time with a 16-entry table per nibble (pshufb), keeps the
+// byte counts of up to `flush` words, then sums each 64-bit lane with psadbw. Rows
+// n .. n + 3 end up in c0 and n + 4 .. n + 7 in c1.
+void block_counts(const uint64_t* w, size_t words, size_t rows, const uint64_t* x, size_t n,
+                  __m256i& c0, __m256i& c1) {
+    // 8 bits per byte per word: 31 words keep every byte count below 256.
+    constexpr size_t flush = 31;
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    auto bytes = [&](__m256i v) {
+        return _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+                               _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    };
+
+    c0 = _mm256_setzero_si256();
+    c1 = c0;
+    for (size_t start = 0; start < words; start += flush) {
+        const size_t end = words - start < flush ? words : start + flush;
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = acc0;
+        for (size_t k = start; k < end; k++) {
+            const __m256i xk = _mm256_set1_epi64x(static_cast<long long>(x[k]));
+            const uint64_t* column = w + k * rows + n;
+            const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column));
+            const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + 4));
+            acc0 = _mm256_add_epi8(acc0, bytes(_mm256_xor_si256(v0, xk)));
+            acc1 = _mm256_add_epi8(acc1, bytes(_mm256_xor_si256(v1, xk)));
+        }
+        c0 = _mm256_add_epi64(c0, _mm256_sad_epu8(acc0, _mm256_setzero_si256()));
+        c1 = _mm256_add_epi64(c1, _mm256_sad_epu8(acc1, _mm256_setzero_si256()));
+    }
+}
+
+// The four 64-bit counts of c as int32.
+__m128i narrow(__m256i c) {
+    const __m256i even = _mm256_permutevar8x32_epi32(c, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+    return _mm256_castsi256_si128(even);
+}
+
+void avx2_xor_popcount(const uint64_t* w, size_t words, size_t rows,
+                       const uint64_t* x, int32_t* count) {
+    for (size_t n = 0; n < rows; n += 8) {
+        __m256i c0, c1;
+        block_counts(w, words, rows, x, n, c0, c1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(count + n), narrow(c0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(count + n + 4), narrow(c1));
+    }
+}
+
+// Rows whose count exceeds the limit, as sign bits (movmskpd), give the complement
+// of the byte of y for each block of eight rows.
+void avx2_xor_popcount_threshold(const uint64_t* w, size_t words, size_t rows,
+                                 const uint64_t* x, const int32_t* limit, uint64_t* y) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(y);
+    for (size_t n = 0; n < rows; n += 8) {
+        __m256i c0, c1;
+        block_counts(w, words, rows, x, n, c0, c1);
+        const __m256i l0 = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(limit + n)));
+        const __m256i l1 = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(limit + n + 4)));
+        const int over = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(c0, l0)))
+                       | _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(c1, l1))) << 4;
+        bytes[n / 8] = uint8_t(~over);
+    }
+    for (size_t b = rows / 8; b % 8 != 0; b++) {
+        bytes[b] = 0;
+    }
+}
+
+constexpr BinaryKernels avx2_table = {"avx2", &avx2_xor_popcount, &avx2_xor_popcount_threshold};
+
+}
+
+const BinaryKernels* binary_detail::avx2_kernels() { return &avx2_table; }
+
+#else
+
+const BinaryKernels* binary_detail::avx2_kernels() { return nullptr; }
+
+#endif
@@ -0,0 +1,51 @@
+#include "binaryKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("avx512f,avx512vpopcntdq")
+
+namespace {
+
+// Counts of rows n .. n + 7, one vpopcntq per word.
+__m512i block_counts(const uint64_t* w, size_t words, size_t rows, const uint64_t* x, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t k = 0; k < words; k++) {
+        const __m512i v = _mm512_loadu_si512(w + k * rows + n);
+        const __m512i xk = _mm512_set1_epi64(static_cast<long long>(x[k]));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_xor_si512(v, xk)));
+    }
+    return acc;
+}
+
+void avx512_xor_popcount(const uint64_t* w, size_t words, size_t rows,
+                         const uint64_t* x, int32_t* count) {
+    for (size_t n = 0; n < rows; n += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(count + n),
+                            _mm512_cvtepi64_epi32(block_counts(w, words, rows, x, n)));
+    }
+}
+
+// Each block of eight rows compares to a mask, which is the byte of y for those rows.
+void avx512_xor_popcount_threshold(const uint64_t* w, size_t words, size_t rows,
+                                   const uint64_t* x, const int32_t* limit, uint64_t* y) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(y);
+    for (size_t n = 0; n < rows; n += 8) {
+        const __m512i l = _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(limit + n)));
+        bytes[n / 8] = _mm512_cmple_epi64_mask(block_counts(w, words, rows, x, n), l);
+    }
+    for (size_t b = rows / 8; b % 8 != 0; b++) {
+        bytes[b] = 0;
+    }
+}
+
+constexpr BinaryKernels avx512_table = {"avx512vpopcntdq", &avx512_xor_popcount, &avx512_xor_popcount_threshold};
+
+}
+
+const BinaryKernels* binary_detail::avx512_kernels() { return &avx512_table; }
+
+#else
+
+const BinaryKernels* binary_detail::avx512_kernels() { return nullptr; }
+
+#endif
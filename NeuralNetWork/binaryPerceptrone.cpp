@@ -0,0 +1,146 @@
+#include "binaryPerceptrone.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+size_t words_for(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+}
+
+BinaryPerceptrone::Workspace::Workspace(const BinaryPerceptrone& model) : sizes(model.sizes) {
+    size_t words = 0;
+    size_t rows = 0;
+    for (const Layer& layer : model.layers) {
+        words = std::max(words, std::max(layer.words, words_for(layer.rows)));
+        rows = std::max(rows, layer.rows);
+    }
+    bits[0].assign(words, 0);
+    bits[1].assign(words, 0);
+    counts.assign(rows, 0);
+    values.assign(model.sizes.back(), 0.0f);
+}
+
+BinaryPerceptrone::BinaryPerceptrone(const Perceptrone<float>& model, const std::vector<float>& thresholds)
+    : sizes(model.get_sizes()),
+      thresholds(thresholds),
+      outputActivation(model.get_activations().back()),
+      activationParameters(model.get_activation_parameters()),
+      kernels(&binary_kernels()) {
+    if (this->thresholds.empty()) {
+        this->thresholds.assign(sizes.front(), 0.0f);
+    }
+    if (this->thresholds.size() != sizes.front()) {
+        throw std::invalid_argument("Need one threshold per input");
+    }
+
+    const auto& biases = model.get_biases();
+    layers.resize(sizes.size() - 1);
+    for (size_t l = 0; l < layers.size(); l++) {
+        LayerView<float> view = model.layer_weights(l);
+        Layer& layer = layers[l];
+        layer.words = words_for(view.inputs);
+        layer.rows = padded_size<uint64_t>(view.outputs);
+        layer.weights.assign(layer.words * layer.rows, 0);
+        layer.limits.assign(layer.rows, -1);
+        layer.scales.assign(layer.rows, 0.0f);
+        layer.bias.assign(layer.rows, 0.0f);
+
+        for (size_t n = 0; n < view.outputs; n++) {
+            double magnitude = 0.0;
+            for (size_t k = 0; k < view.inputs; k++) {
+                magnitude += std::abs(view(k, n));
+                if (view(k, n) >= 0.0f) {
+                    layer.weights[k / 64 * layer.rows + n] |= uint64_t(1) << (k % 64);
+                }
+            }
+            const double scale = magnitude / double(view.inputs);
+            const double bias = biases[l + 1][n];
+            layer.scales[n] = float(scale);
+            layer.bias[n] = float(bias);
+
+            // scale * (inputs - 2 * count) + bias >= 0, solved for count.
+            const double inputs = double(view.inputs);
+            double limit = scale > 0.0 ? std::floor((inputs + bias / scale) / 2.0) : (bias >= 0.0 ? inputs : -1.0);
+            limit = std::max(-1.0, std::min(inputs, limit));
+            layer.limits[n] = int32_t(limit);
+        }
+    }
+
+    workspace = Workspace(*this);
+}
+
+std::vector<float> BinaryPerceptrone::predict(const std::vector<float>& input) {
+    if (input.size() != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    std::vector<float> output(sizes.back());
+    predict_into(workspace, input.data(), output.data());
+    return output;
+}
+
+void BinaryPerceptrone::predict_into(const float* input, float* output) {
+    predict_into(workspace, input, output);
+}
+
+void BinaryPerceptrone::check_workspace(const Workspace& ws) const {
+    if (ws.sizes != sizes) {
+        throw std::invalid_argument("Workspace does not match network structure");
+    }
+}
+
+void BinaryPerceptrone::outputs(const int32_t* counts, float* output) const {
+    const Layer& layer = layers.back();
+    const float inputs = float(sizes[sizes.size() - 2]);
+    for (size_t n = 0; n < sizes.back(); n++) {
+        output[n] = layer.scales[n] * (inputs - 2.0f * float(counts[n])) + layer.bias[n];
+    }
+    Activator<float>::apply(outputActivation, output, sizes.back(), activationParameters);
+}
+
+void BinaryPerceptrone::predict_into(Workspace& ws, const float* input, float* output) const {
+    check_workspace(ws);
+    uint64_t* x = ws.bits[0].data();
+    std::fill(x, x + layers.front().words, 0);
+    for (size_t i = 0; i < sizes.front(); i++) {
+        x[i / 64] |= uint64_t(input[i] > thresholds[i]) << (i % 64);
+    }
+
+    for (size_t l = 0; l + 1 < layers.size(); l++) {
+        const Layer& layer = layers[l];
+        kernels->xor_popcount_threshold(layer.weights.data(), layer.words, layer.rows,
+                                        ws.bits[l % 2].data(), layer.limits.data(), ws.bits[(l + 1) % 2].data());
+    }
+    const Layer& last = layers.back();
+    kernels->xor_popcount(last.weights.data(), last.words, last.rows,
+                          ws.bits[(layers.size() - 1) % 2].data(), ws.counts.data());
+    outputs(ws.counts.data(), output);
+}
+
+size_t BinaryPerceptrone::predict_argmax(const float* input) {
+    return predict_argmax(workspace, input);
+}
+
+size_t BinaryPerceptrone::predict_argmax(Workspace& ws, const float* input) const {
+    float* y = ws.values.data();
+    predict_into(ws, input, y);
+    return std::max_element(y, y + sizes.back()) - y;
+}
+
+QuantizationReport BinaryPerceptrone::compare(const Perceptrone<float>& reference,
+                                              const float* inputs, size_t rows) const {
+    return compare_with_reference(*this, reference, inputs, rows);
+}
+
+size_t BinaryPerceptrone::parameter_bytes() const {
+    size_t bytes = thresholds.size() * sizeof(float);
+    for (const auto& layer : layers) {
+        bytes += layer.weights.size() * sizeof(uint64_t)
+               + layer.limits.size() * sizeof(int32_t)
+               + layer.scales.size() * sizeof(float)
+               + layer.bias.size() * sizeof(float);
+    }
+    return bytes;
+}
@@ -0,0 +1,94 @@
+#ifndef BINARY_PERCEPTRONE_H
+#define BINARY_PERCEPTRONE_H
+
+#include <cstdint>
+#include <vector>
+#include "Perceptrone.h"
+#include "binaryKernels.h"
+#include "quantizedPerceptrone.h"
+
+// Binarized version of a Perceptrone<float> (XNOR-Net style). Every weight becomes
+// its sign and every row keeps the mean of its absolute weights as a scale, so a
+// neuron computes z = scale * (W . x) + bias with x and W in {-1, +1}, which is
+// inputs - 2 * popcount(W ^ x) on the packed bits.
+//
+// The inputs are binarized as input[i] > thresholds[i]. Hidden layers act as
+// BINARY_STEP, whatever the source activation: a neuron is +1 when z >= 0. Since
+// the scale is positive this is popcount(W ^ x) <= limit with an integer limit
+// worked out once, so hidden layers do no floating point. The output layer
+// computes z in float and applies the model's last activation.
+//
+// Binarizing a network trained in float loses most of its accuracy: the snake
+// policy's binarized version picks the same action for only about a quarter of the
+// states. The mode is meant for models searched as binary networks, such as
+// GeneticSnakeTrainer with binary_policy set, which scores each Perceptrone by
+// the games its binarized version plays.
+class BinaryPerceptrone {
+public:
+    class Workspace {
+    public:
+        Workspace() = default;
+        explicit Workspace(const BinaryPerceptrone& model);
+
+    private:
+        friend class BinaryPerceptrone;
+
+        std::vector<size_t> sizes;
+        // Packed activations of the layer being read and the one being written.
+        AlignedVector<uint64_t> bits[2];
+        AlignedVector<int32_t> counts;
+        std::vector<float> values;
+    };
+
+    // Thresholds default to 0 for every input, i.e. the sign of the input.
+    explicit BinaryPerceptrone(const Perceptrone<float>& model,
+                               const std::vector<float>& thresholds = {});
+
+    Workspace make_workspace() const { return Workspace(*this); }
+
+    std::vector<float> predict(const std::vector<float>& input);
+    void predict_into(const float* input, float* output);
+    // The Workspace overloads throw std::invalid_argument if ws was made for other
+    // layer sizes.
+    void predict_into(Workspace& ws, const float* input, float* output) const;
+    // Index of the largest output, the first of equal ones.
+    size_t predict_argmax(const float* input);
+    size_t predict_argmax(Workspace& ws, const float* input) const;
+
+    // See compare_with_reference; quantized_bytes is the size of the binarized parameters.
+    QuantizationReport compare(const Perceptrone<float>& reference,
+                               const float* inputs, size_t rows) const;
+
+    const std::vector<size_t>& get_sizes() const { return sizes; }
+    size_t parameter_bytes() const;
+    // Lowered to what the CPU supports, as for Perceptrone::set_simd_isa.
+    void set_simd_isa(SimdIsa isa) { kernels = &binary_kernels(isa); }
+    const char* kernel_name() const { return kernels->name; }
+
+private:
+    struct Layer {
+        // words x rows, word-major (see BinaryKernels), rows = padded_size<uint64_t>(outputs).
+        AlignedVector<uint64_t> weights;
+        size_t words;
+        size_t rows;
+        // Hidden layers: +1 when the count is at most limits[n]; padding rows never are.
+        std::vector<int32_t> limits;
+        // Output layer: z = scales[n] * (inputs - 2 * count) + bias[n].
+        std::vector<float> scales;
+        std::vector<float> bias;
+    };
+
+    void check_workspace(const Workspace& ws) const;
+    // Output values from the counts of the last layer.
+    void outputs(const int32_t* counts, float* output) const;
+
+    std::vector<size_t> sizes;
+    std::vector<float> thresholds;
+    std::vector<Layer> layers;
+    Activator<float>::Function outputActivation;
+    Activator<float>::Parameters activationParameters;
+    const BinaryKernels* kernels;
+    Workspace workspace;
+};
+
+#endif
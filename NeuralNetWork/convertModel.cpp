@@ -0,0 +1,47 @@
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+#include "Perceptrone.h"
+
+using namespace std;
+
+// MLPConvert <weights.bin> <model.mlp> [--double] <activation>...
+// Reads a save_weights file and writes it as a model file. The old file holds only
+// the layer sizes, so the activations are given by name, one per layer after the
+// input: MLPConvert weights.bin weights.mlp relu relu relu identity
+template<typename T>
+void convert(const char* from, const char* to, const vector<string>& names) {
+    vector<typename Activator<T>::Function> activations;
+    for (const auto& name : names) {
+        activations.push_back(Activator<T>::from_name(name));
+    }
+    Perceptrone<T> model = Perceptrone<T>::from_legacy_file(from, activations);
+    model.save(to);
+
+    const auto& sizes = model.get_sizes();
+    printf("%s -> %s:", from, to);
+    for (size_t size : sizes) printf(" %zu", size);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Использование: %s <weights.bin> <model.mlp> [--double] <активация>...\n", argv[0]);
+        return 2;
+    }
+    const bool as_double = strcmp(argv[3], "--double") == 0;
+    const vector<string> names(argv + (as_double ? 4 : 3), argv + argc);
+    try {
+        if (as_double) {
+            convert<double>(argv[1], argv[2], names);
+        } else {
+            convert<float>(argv[1], argv[2], names);
+        }
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
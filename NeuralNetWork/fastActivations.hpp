@@ -0,0 +1,182 @@
+#ifndef FAST_ACTIVATIONS_HPP
+#define FAST_ACTIVATIONS_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Approximations behind Activator<T>::Accuracy FAST and TABLE. Both are branch free
+// and call nothing from libm, so the elementwise loops in the kernel epilogues
+// vectorize under each kernel's target ISA.
+//
+// Largest absolute error against the exact (libm) functions, float, measured by
+// MLPBenchmark over x in [-20, 20] (swish and gelu also grow with |x| beyond that):
+//
+//              sigmoid   tanh      swish     gelu      elu       selu      softplus
+//   FAST       1.2e-7    1.2e-7    9.5e-7    4.8e-7    1e-9      2.4e-7    9.5e-7
+//   TABLE      2.4e-7    4.8e-7    2.2e-6    2.3e-6    1.9e-8    3.4e-6    9.5e-7
+//
+// The elu and selu figures are for the default Activator<T>::Parameters (alpha 0.01,
+// selu_alpha 1.67326, selu_scale 1.0507); they scale with those factors. With
+// T = double, FAST is within 4e-15 and TABLE stays near the float figures, since the
+// tables are only sampled 256 times per unit.
+
+namespace fast_detail {
+
+template<typename T> struct FloatBits;
+template<> struct FloatBits<float> {
+    using U = uint32_t;
+    static constexpr int mantissa = 23;
+    static constexpr U bias = 127;
+    // Adding this rounds to an integer held in the low mantissa bits.
+    static constexpr float shifter = 0x1.8p23f;
+    static constexpr float exp_min = -87.3f;
+    static constexpr float exp_max = 88.7f;
+    // Taylor terms of e^r for |r| <= ln 2 / 2, and of the atanh series in log1p.
+    static constexpr int exp_terms = 7;
+    static constexpr int log_terms = 6;
+};
+template<> struct FloatBits<double> {
+    using U = uint64_t;
+    static constexpr int mantissa = 52;
+    static constexpr U bias = 1023;
+    static constexpr double shifter = 0x1.8p52;
+    static constexpr double exp_min = -708.0;
+    static constexpr double exp_max = 709.0;
+    static constexpr int exp_terms = 12;
+    static constexpr int log_terms = 14;
+};
+
+}
+
+template<typename T>
+struct FastMath {
+    using Bits = fast_detail::FloatBits<T>;
+    using U = typename Bits::U;
+
+    // inverse[k] = 1 / k, so the polynomial loops multiply instead of divide.
+    struct Coefficients {
+        static constexpr int size = 2 * Bits::log_terms + 2 > Bits::exp_terms + 1
+                                  ? 2 * Bits::log_terms + 2 : Bits::exp_terms + 1;
+        T inverse[size] = {};
+        constexpr Coefficients() {
+            for (int k = 1; k < size; k++) inverse[k] = T(1) / T(k);
+        }
+    };
+    static constexpr Coefficients coefficients{};
+
+    static T clamp(T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+    // e^x = 2^n * e^r with n = round(x / ln 2) and r = x - n ln 2, Cody-Waite split.
+    static T exp(T x) {
+        x = clamp(x, T(Bits::exp_min), T(Bits::exp_max));
+        const T shifted = x * T(1.44269504088896340736) + Bits::shifter;
+        const T n = shifted - Bits::shifter;
+        const T r = (x - n * T(0.693145751953125)) - n * T(1.42860682030941723212e-6);
+
+        T p = T(1);
+        for (int k = Bits::exp_terms; k >= 1; k--) {
+            p = T(1) + p * r * coefficients.inverse[k];
+        }
+
+        U bits;
+        std::memcpy(&bits, &shifted, sizeof(bits));
+        bits = (bits << Bits::mantissa) + (Bits::bias << Bits::mantissa);
+        T scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return p * scale;
+    }
+
+    // log(1 + u) for u in [0, 1], as 2 atanh(s) with s = u / (2 + u) <= 1/3.
+    static T log1p_unit(T u) {
+        const T s = u / (T(2) + u);
+        const T s2 = s * s;
+        T p = T(0);
+        for (int k = Bits::log_terms; k >= 0; k--) {
+            p = coefficients.inverse[2 * k + 1] + p * s2;
+        }
+        return T(2) * s * p;
+    }
+
+    static T sigmoid(T x) { return T(1) / (T(1) + exp(-x)); }
+    static T tanh(T x) {
+        const T t = T(1) - T(2) / (exp(T(2) * std::abs(x)) + T(1));
+        return x < 0 ? -t : t;
+    }
+    static T swish(T x) { return x * sigmoid(x); }
+    // The tanh form of GELU, written as x * sigmoid(2 * inner).
+    static T gelu(T x) {
+        const T inner = T(0.79788456080286535588) * (x + T(0.044715) * x * x * x);
+        return x * sigmoid(T(2) * inner);
+    }
+    static T elu(T x, T alpha) { return x >= 0 ? x : alpha * (exp(x) - T(1)); }
+    static T selu(T x, T alpha, T scale) { return scale * (x > 0 ? x : alpha * (exp(x) - T(1))); }
+    static T softplus(T x) { return (x > 0 ? x : T(0)) + log1p_unit(exp(-std::abs(x))); }
+};
+
+// Linearly interpolated tables, 256 points per unit:
+//   sigmoid on [-16, 16], which also gives tanh, swish and gelu;
+//   e^x on [-16, 0] for elu and selu;
+//   log(1 + e^-t) on [0, 16] for softplus.
+// Outside the ranges the functions are within 1.2e-7 of their limits, which is
+// what the tables return. Built once, on first use, in T.
+template<typename T>
+class ActivationTable {
+public:
+    static const ActivationTable& instance() {
+        static const ActivationTable table;
+        return table;
+    }
+
+    T sigmoid(T x) const { return lookup(sigmoidTable.data(), x + T(range), 2 * range); }
+    T tanh(T x) const { return T(2) * sigmoid(T(2) * x) - T(1); }
+    T swish(T x) const { return x * sigmoid(x); }
+    T gelu(T x) const {
+        return x * sigmoid(T(1.59576912160573071176) * (x + T(0.044715) * x * x * x));
+    }
+    T elu(T x, T alpha) const { return x >= 0 ? x : alpha * (exp_negative(x) - T(1)); }
+    T selu(T x, T alpha, T scale) const {
+        return scale * (x > 0 ? x : alpha * (exp_negative(x) - T(1)));
+    }
+    T softplus(T x) const {
+        return (x > 0 ? x : T(0)) + lookup(softplusTable.data(), std::abs(x), range);
+    }
+
+private:
+    static constexpr int range = 16;
+    static constexpr int per_unit = 256;
+
+    ActivationTable() {
+        fill(sigmoidTable, 2 * range, [](double t) { return 1.0 / (1.0 + std::exp(range - t)); });
+        fill(expTable, range, [](double t) { return std::exp(t - range); });
+        fill(softplusTable, range, [](double t) { return std::log1p(std::exp(-t)); });
+    }
+
+    template<typename F>
+    static void fill(std::vector<T>& table, int units, F f) {
+        table.resize(size_t(units) * per_unit + 2);
+        for (size_t i = 0; i < table.size(); i++) {
+            table[i] = T(f(double(i) / per_unit));
+        }
+    }
+
+    // Table of f(t) for t in [0, units], one extra point past the end so the
+    // interpolation never reads out of bounds. The clamp sends a NaN `t` to 0 so it
+    // never becomes an index, and the NaN is returned, as the exact functions do.
+    static T lookup(const T* table, T t, int units) {
+        const T x = (t > T(0) ? (t < T(units) ? t : T(units)) : T(0)) * T(per_unit);
+        const int32_t i = static_cast<int32_t>(x);
+        const T frac = x - T(i);
+        const T value = table[i] + frac * (table[i + 1] - table[i]);
+        return t == t ? value : t;
+    }
+
+    T exp_negative(T x) const { return lookup(expTable.data(), x + T(range), range); }
+
+    std::vector<T> sigmoidTable;
+    std::vector<T> expTable;
+    std::vector<T> softplusTable;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef GENERATED_MODEL_HPP
+#define GENERATED_MODEL_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include "alignedAllocator.hpp"
+#include "mlpActivators.hpp"
+
+// Building blocks of the headers MLPCodegen writes (see modelCodegen.cpp). A generated
+// model is a namespace of constexpr weight arrays and a predict() that calls dense<>
+// once per layer with every size, activation and parameter a compile-time constant.
+//
+// dense<> adds up each neuron in the same order as the runtime kernels
+// (simdKernelsImpl.hpp): `lanes` partial sums, input i going to sum i % lanes, folded
+// in halves, then the bias. Multiply-adds are fused when the header is compiled for a
+// target with FMA, like the AVX2 and AVX-512 kernels, and separate otherwise, like
+// the scalar and SSE2 kernels, so the outputs are bit-equal to Perceptrone::predict
+// running the matching kernels. It gets there faster by storing weights input-major
+// and vectorizing across neurons: the partial sums of a block of neurons stay in
+// registers and fold with vertical adds instead of a horizontal reduction per
+// neuron, and the zero padding of each row, which cannot change a sum that starts
+// at +0, is never visited.
+namespace generated_model {
+
+#if defined(__FMA__)
+constexpr bool fused_multiply_add = true;
+#else
+constexpr bool fused_multiply_add = false;
+#endif
+
+template<typename T>
+inline T multiply_add(T a, T b, T c) {
+#if defined(__FMA__)
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+// Neurons computed together, one vector register of the target.
+#if defined(__AVX512F__)
+constexpr size_t vector_bytes = 64;
+#elif defined(__AVX__)
+constexpr size_t vector_bytes = 32;
+#else
+constexpr size_t vector_bytes = 16;
+#endif
+
+// Calls f(std::integral_constant<size_t, L>()) for L = 0, 1, ..., so each call sees
+// its index as a constant.
+template<typename F, size_t... L>
+inline void unroll(F&& f, std::index_sequence<L...>) {
+    (f(std::integral_constant<size_t, L>()), ...);
+}
+
+// y[n] = F(b[n] + sum over i of w[i][n] * x[i]) for n < Outputs. Rows of w are zero
+// padded to Columns = padded_size<T>(Outputs).
+template<typename T, size_t Inputs, size_t Outputs, typename Activator<T>::Function F, size_t Columns>
+inline void dense(const T (&w)[Inputs][Columns], const T (&b)[Outputs], const T* x, T* y,
+                  const typename Activator<T>::Parameters& p) {
+    constexpr size_t lanes = MLP_ALIGNMENT / sizeof(T);
+    constexpr size_t block = vector_bytes / sizeof(T);
+    constexpr size_t whole = Inputs / lanes * lanes;
+    static_assert(Columns == padded_size<T>(Outputs), "Weight rows must be padded to MLP_ALIGNMENT");
+
+    for (size_t n = 0; n < Outputs; n += block) {
+        // acc[l][j]: partial sum l of neuron n + j. Indexed by constants only, so it
+        // stays in registers.
+        T acc[lanes][block] = {};
+        auto add = [&](size_t i, auto l) {
+            const T xi = x[i];
+            for (size_t j = 0; j < block; j++) {
+                acc[l][j] = multiply_add(w[i][n + j], xi, acc[l][j]);
+            }
+        };
+        for (size_t k = 0; k < whole; k += lanes) {
+            unroll([&](auto l) { add(k + l, l); }, std::make_index_sequence<lanes>());
+        }
+        unroll([&](auto l) { add(whole + l, l); }, std::make_index_sequence<Inputs - whole>());
+        for (size_t half = lanes / 2; half > 0; half /= 2) {
+            for (size_t l = 0; l < half; l++) {
+                for (size_t j = 0; j < block; j++) {
+                    acc[l][j] += acc[l + half][j];
+                }
+            }
+        }
+        for (size_t j = 0; j < block && n + j < Outputs; j++) {
+            y[n + j] = b[n + j] + acc[0][j];
+        }
+    }
+    Activator<T>::apply(F, y, Outputs, p);
+}
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef HALF_FLOAT_HPP
+#define HALF_FLOAT_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// 16-bit storage formats for weights. Both convert implicitly to and from float;
+// arithmetic happens in float. Conversions to 16 bits round to nearest even.
+
+inline float half_bits_to_float(uint16_t h) {
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: normalize into a float exponent.
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline uint16_t float_to_half_bits(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    const uint16_t sign = uint16_t((x >> 16) & 0x8000);
+    x &= 0x7fffffff;
+
+    if (x > 0x7f800000) return sign | 0x7e00;
+    // 65520 and above round to infinity.
+    if (x >= 0x477ff000) return sign | 0x7c00;
+    if (x < 0x38800000) {
+        // Below the smallest normal half: count units of 2^-24.
+        float magnitude;
+        std::memcpy(&magnitude, &x, sizeof(magnitude));
+        return sign | uint16_t(std::nearbyint(magnitude * 16777216.0f));
+    }
+    // Rebias the exponent (-112 << 23) and round the 13 dropped bits to nearest even.
+    x += 0xc8000fff + ((x >> 13) & 1);
+    return sign | uint16_t(x >> 13);
+}
+
+inline float bfloat16_bits_to_float(uint16_t b) {
+    uint32_t bits = uint32_t(b) << 16;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline uint16_t float_to_bfloat16_bits(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    if ((x & 0x7fffffff) > 0x7f800000) return uint16_t((x >> 16) | 0x40);
+    x += 0x7fff + ((x >> 16) & 1);
+    return uint16_t(x >> 16);
+}
+
+// IEEE 754 binary16: 5 exponent bits, 10 mantissa bits.
+struct float16 {
+    uint16_t bits;
+
+    float16() = default;
+    float16(float value) : bits(float_to_half_bits(value)) {}
+    operator float() const { return half_bits_to_float(bits); }
+};
+
+// bfloat16: the top half of a float, with float's exponent range and 7 mantissa bits.
+struct bfloat16 {
+    uint16_t bits;
+
+    bfloat16() = default;
+    bfloat16(float value) : bits(float_to_bfloat16_bits(value)) {}
+    operator float() const { return bfloat16_bits_to_float(bits); }
+};
+
+#endif
@@ -0,0 +1,472 @@
+#include "inferenceServer.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace inference_protocol;
+
+namespace {
+
+// Largest request payload the server reads, so a bad header cannot make it allocate
+// or wait for gigabytes.
+constexpr uint32_t max_request_inputs = uint32_t(1) << 24;
+
+bool read_full(int fd, void* data, size_t bytes) {
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        const ssize_t n = ::recv(fd, p, bytes, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= size_t(n);
+    }
+    return true;
+}
+
+bool write_full(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const ssize_t n = ::send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= size_t(n);
+    }
+    return true;
+}
+
+bool skip_bytes(int fd, size_t bytes) {
+    char sink[4096];
+    while (bytes > 0) {
+        const size_t n = std::min(bytes, sizeof(sink));
+        if (!read_full(fd, sink, n)) return false;
+        bytes -= n;
+    }
+    return true;
+}
+
+sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is too long");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+}
+
+LatencySummary summarize_latencies(std::vector<double>& micros, double seconds) {
+    LatencySummary summary;
+    summary.requests = micros.size();
+    summary.seconds = seconds;
+    if (micros.empty()) return summary;
+
+    auto percentile = [&](double q) {
+        auto nth = micros.begin() + ptrdiff_t(q * double(micros.size() - 1));
+        std::nth_element(micros.begin(), nth, micros.end());
+        return *nth;
+    };
+    summary.p50_us = percentile(0.50);
+    summary.p99_us = percentile(0.99);
+    return summary;
+}
+
+// Lives on the stack of the connection thread while the request is queued.
+struct InferenceServer::Pending {
+    const float* input;
+    float* output;
+    Clock::time_point arrival;
+    bool done = false;
+};
+
+struct InferenceServer::Batcher {
+    explicit Batcher(const std::string& filename)
+        : snapshots(std::make_shared<const MappedPerceptrone<float>>(filename)),
+          reader(snapshots),
+          inputs(reader.model().get_sizes().front()),
+          outputs(reader.model().get_sizes().back()) {}
+
+    ModelSnapshots<MappedPerceptrone<float>> snapshots;
+    // Used by the batch thread only.
+    ModelSnapshots<MappedPerceptrone<float>>::Reader reader;
+    const size_t inputs;
+    const size_t outputs;
+    std::unique_ptr<ModelFileWatcher<MappedPerceptrone<float>>> watcher;
+
+    std::mutex mutex;
+    // Signalled when a request is queued; the batch thread waits on it.
+    std::condition_variable queued;
+    // Signalled when a batch is answered; connections wait on it.
+    std::condition_variable answered;
+    std::deque<Pending*> queue;
+    bool stopping = false;
+
+    // Owned by the batch thread.
+    std::vector<Pending*> batch;
+    std::vector<float> batchInput;
+    std::vector<float> batchOutput;
+    std::thread thread;
+};
+
+struct InferenceServer::Connection {
+    explicit Connection(int socket) : fd(socket) {}
+
+    const int fd;
+    std::thread thread;
+    std::atomic<bool> finished{false};
+};
+
+InferenceServer::InferenceServer(const std::string& socket_path,
+                                 const std::vector<std::string>& model_files, Options opts)
+    : socketPath(socket_path), options(opts) {
+    if (options.max_batch == 0) {
+        throw std::invalid_argument("max_batch must be positive");
+    }
+    for (const auto& file : model_files) {
+        batchers.push_back(std::make_unique<Batcher>(file));
+    }
+    if (options.reload_interval.count() > 0) {
+        for (size_t i = 0; i < batchers.size(); i++) {
+            Batcher& b = *batchers[i];
+            const size_t inputs = b.inputs, outputs = b.outputs;
+            auto report = [this, i](uint64_t version, const char* error) {
+                if (options.on_reload) options.on_reload(i, version, error);
+            };
+            auto load = [inputs, outputs](const std::string& filename) {
+                auto model = ModelFileLoader<MappedPerceptrone<float>>::load(filename);
+                if (model->get_sizes().front() != inputs || model->get_sizes().back() != outputs) {
+                    throw std::runtime_error("Reloaded model changes the input or output size");
+                }
+                return model;
+            };
+            b.watcher = std::make_unique<ModelFileWatcher<MappedPerceptrone<float>>>(
+                b.snapshots, model_files[i], options.reload_interval, report, load);
+        }
+    }
+
+    const sockaddr_un address = socket_address(socketPath);
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) throw std::runtime_error("Cannot create socket");
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        ::close(listenFd);
+        throw std::runtime_error("Cannot listen on socket");
+    }
+
+    windowStart = Clock::now();
+    for (auto& batcher : batchers) {
+        Batcher* b = batcher.get();
+        b->thread = std::thread([this, b] { run_batches(*b); });
+    }
+    acceptThread = std::thread([this] { accept_loop(); });
+}
+
+InferenceServer::~InferenceServer() {
+    stop();
+}
+
+void InferenceServer::stop() {
+    if (stopping.exchange(true)) return;
+
+    for (auto& batcher : batchers) {
+        if (batcher->watcher) batcher->watcher->stop();
+    }
+
+    // Wakes the blocked accept.
+    ::shutdown(listenFd, SHUT_RDWR);
+    acceptThread.join();
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+
+    // Connections wake from their blocking reads; one waiting for a batch still gets
+    // its answer, since the batch threads drain their queues before they stop.
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (auto& connection : connections) {
+            ::shutdown(connection.fd, SHUT_RDWR);
+        }
+    }
+    reap_connections(true);
+
+    for (auto& batcher : batchers) {
+        {
+            std::lock_guard<std::mutex> lock(batcher->mutex);
+            batcher->stopping = true;
+        }
+        batcher->queued.notify_one();
+        batcher->thread.join();
+    }
+}
+
+std::shared_ptr<const MappedPerceptrone<float>> InferenceServer::model(size_t index) const {
+    return batchers.at(index)->snapshots.snapshot();
+}
+
+InferenceServer::Stats InferenceServer::take_stats() {
+    std::vector<double> window;
+    Stats stats;
+    const Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        window.swap(latencies);
+        stats.batches = std::exchange(batches, 0);
+        stats.latency.seconds = std::chrono::duration<double>(now - windowStart).count();
+        windowStart = now;
+    }
+    stats.latency = summarize_latencies(window, stats.latency.seconds);
+    return stats;
+}
+
+void InferenceServer::accept_loop() {
+    for (;;) {
+        const int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (stopping) return;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+
+        reap_connections(false);
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        if (stopping) {
+            ::close(fd);
+            return;
+        }
+        connections.emplace_back(fd);
+        Connection& connection = connections.back();
+        openConnections++;
+        connection.thread = std::thread([this, &connection] {
+            serve(connection);
+            openConnections--;
+            connection.finished = true;
+            // The connections left may all be waiting now.
+            wake_batchers();
+        });
+    }
+}
+
+// Joins and closes finished connections, or all of them. The descriptor is closed
+// here rather than by its thread, so stop() never shuts down a reused number.
+void InferenceServer::reap_connections(bool all) {
+    std::list<Connection> done;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (auto it = connections.begin(); it != connections.end();) {
+            auto next = std::next(it);
+            if (all || it->finished) done.splice(done.end(), connections, it);
+            it = next;
+        }
+    }
+    for (auto& connection : done) {
+        connection.thread.join();
+        ::close(connection.fd);
+    }
+}
+
+// Taking each mutex orders the notification after a batch thread's predicate check,
+// so the wakeup cannot fall between its check and its wait.
+void InferenceServer::wake_batchers() {
+    for (auto& batcher : batchers) {
+        { std::lock_guard<std::mutex> lock(batcher->mutex); }
+        batcher->queued.notify_one();
+    }
+}
+
+void InferenceServer::serve(Connection& connection) {
+    const int fd = connection.fd;
+    std::vector<float> input;
+    std::vector<float> output;
+
+    Request header;
+    while (!stopping && read_full(fd, &header, sizeof(header))) {
+        if (header.magic != magic || header.inputs > max_request_inputs) {
+            const Response response = {BAD_REQUEST, 0, 0};
+            write_full(fd, &response, sizeof(response));
+            return;
+        }
+        if (header.model >= batchers.size()) {
+            const Response response = {UNKNOWN_MODEL, 0, 0};
+            if (!skip_bytes(fd, header.inputs * sizeof(float)) ||
+                !write_full(fd, &response, sizeof(response))) return;
+            continue;
+        }
+
+        Batcher& batcher = *batchers[header.model];
+        Response response = {OK, uint32_t(batcher.inputs), uint32_t(batcher.outputs)};
+        if (header.inputs != batcher.inputs) {
+            if (header.inputs != 0) response.status = WRONG_INPUT_SIZE;
+            if (!skip_bytes(fd, header.inputs * sizeof(float)) ||
+                !write_full(fd, &response, sizeof(response))) return;
+            continue;
+        }
+
+        input.resize(batcher.inputs);
+        output.resize(batcher.outputs);
+        if (!read_full(fd, input.data(), input.size() * sizeof(float))) return;
+
+        Pending request{input.data(), output.data(), Clock::now()};
+        bool everyone_waiting;
+        {
+            std::lock_guard<std::mutex> lock(batcher.mutex);
+            batcher.queue.push_back(&request);
+            everyone_waiting = ++queuedRequests >= openConnections;
+        }
+        if (everyone_waiting) {
+            wake_batchers();
+        } else {
+            batcher.queued.notify_one();
+        }
+        {
+            std::unique_lock<std::mutex> lock(batcher.mutex);
+            batcher.answered.wait(lock, [&] { return request.done; });
+        }
+
+        if (!write_full(fd, &response, sizeof(response)) ||
+            !write_full(fd, output.data(), output.size() * sizeof(float))) return;
+    }
+}
+
+void InferenceServer::run_batches(Batcher& b) {
+    const size_t max_batch = options.max_batch;
+    b.batchInput.resize(max_batch * b.inputs);
+    b.batchOutput.resize(max_batch * b.outputs);
+
+    std::unique_lock<std::mutex> lock(b.mutex);
+    for (;;) {
+        b.queued.wait(lock, [&] { return b.stopping || !b.queue.empty(); });
+        if (b.queue.empty()) return;
+
+        // Wait for a full batch, but never keep the oldest request past its deadline.
+        const Clock::time_point deadline = b.queue.front()->arrival + options.max_latency;
+        b.queued.wait_until(lock, deadline, [&] {
+            return b.stopping || b.queue.size() >= max_batch || queuedRequests >= openConnections;
+        });
+
+        const size_t rows = std::min(b.queue.size(), max_batch);
+        b.batch.assign(b.queue.begin(), b.queue.begin() + ptrdiff_t(rows));
+        b.queue.erase(b.queue.begin(), b.queue.begin() + ptrdiff_t(rows));
+        queuedRequests -= rows;
+        lock.unlock();
+
+        for (size_t r = 0; r < rows; r++) {
+            std::copy(b.batch[r]->input, b.batch[r]->input + b.inputs, b.batchInput.begin() + r * b.inputs);
+        }
+        b.reader.predict_batch(b.batchInput.data(), rows, b.inputs, b.batchOutput.data());
+        for (size_t r = 0; r < rows; r++) {
+            const float* y = b.batchOutput.data() + r * b.outputs;
+            std::copy(y, y + b.outputs, b.batch[r]->output);
+        }
+
+        const Clock::time_point now = Clock::now();
+        {
+            std::lock_guard<std::mutex> stats(statsMutex);
+            for (const Pending* request : b.batch) {
+                latencies.push_back(std::chrono::duration<double, std::micro>(now - request->arrival).count());
+            }
+            batches++;
+        }
+
+        lock.lock();
+        for (Pending* request : b.batch) {
+            request->done = true;
+        }
+        b.answered.notify_all();
+    }
+}
+
+InferenceClient::InferenceClient(const std::string& socket_path) {
+    const sockaddr_un address = socket_address(socket_path);
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error("Cannot create socket");
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot connect to inference server");
+    }
+}
+
+InferenceClient::~InferenceClient() {
+    ::close(fd);
+}
+
+Response InferenceClient::exchange(uint32_t model, const float* input, size_t inputs) {
+    const Request request = {magic, model, uint32_t(inputs)};
+    Response response;
+    if (!write_full(fd, &request, sizeof(request)) ||
+        !write_full(fd, input, inputs * sizeof(float)) ||
+        !read_full(fd, &response, sizeof(response))) {
+        throw std::runtime_error("Inference server closed the connection");
+    }
+    switch (response.status) {
+        case OK: return response;
+        case UNKNOWN_MODEL: throw std::invalid_argument("Unknown model index");
+        case WRONG_INPUT_SIZE: throw std::invalid_argument("Input size mismatch");
+        default: throw std::runtime_error("Inference server rejected the request");
+    }
+}
+
+InferenceClient::Shape InferenceClient::describe(uint32_t model) {
+    const Response response = exchange(model, nullptr, 0);
+    return {response.inputs, response.outputs};
+}
+
+void InferenceClient::predict(uint32_t model, const float* input, size_t inputs, float* output, size_t outputs) {
+    if (inputs == 0) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    const Response response = exchange(model, input, inputs);
+    if (response.outputs > outputs) {
+        skip_bytes(fd, response.outputs * sizeof(float));
+        throw std::invalid_argument("Output size mismatch");
+    }
+    if (!read_full(fd, output, response.outputs * sizeof(float))) {
+        throw std::runtime_error("Inference server closed the connection");
+    }
+}
+
+#else
+
+LatencySummary summarize_latencies(std::vector<double>& micros, double seconds) {
+    LatencySummary summary;
+    summary.requests = micros.size();
+    summary.seconds = seconds;
+    return summary;
+}
+
+struct InferenceServer::Batcher {};
+struct InferenceServer::Connection {};
+
+InferenceServer::InferenceServer(const std::string&, const std::vector<std::string>&, Options) {
+    throw std::runtime_error("Unix domain sockets are not supported on this platform");
+}
+
+InferenceServer::~InferenceServer() {}
+void InferenceServer::stop() {}
+std::shared_ptr<const MappedPerceptrone<float>> InferenceServer::model(size_t) const {
+    throw std::out_of_range("No models are served on this platform");
+}
+InferenceServer::Stats InferenceServer::take_stats() { return {}; }
+
+InferenceClient::InferenceClient(const std::string&) {
+    throw std::runtime_error("Unix domain sockets are not supported on this platform");
+}
+
+InferenceClient::~InferenceClient() {}
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef INFERENCE_SERVER_H
+#define INFERENCE_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "modelSnapshots.h"
+
+// Wire format between InferenceClient and InferenceServer: a fixed header followed by
+// raw floats. Both ends are on the same host, so everything is in host byte order.
+namespace inference_protocol {
+    constexpr uint32_t magic = 0x3151524Du;  // "MRQ1"
+
+    enum Status : uint32_t { OK = 0, BAD_REQUEST, UNKNOWN_MODEL, WRONG_INPUT_SIZE };
+
+    // Followed by `inputs` floats. inputs == 0 only asks for the model's shape.
+    struct Request {
+        uint32_t magic;
+        uint32_t model;
+        uint32_t inputs;
+    };
+
+    // Carries the model's shape whenever the model exists, and is followed by
+    // `outputs` floats only when status is OK and the request had inputs.
+    struct Response {
+        uint32_t status;
+        uint32_t inputs;
+        uint32_t outputs;
+    };
+}
+
+// Request latencies over a window of `seconds`.
+struct LatencySummary {
+    size_t requests = 0;
+    double seconds = 0.0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+
+    double requests_per_second() const { return seconds > 0.0 ? requests / seconds : 0.0; }
+};
+
+// Reorders `micros`.
+LatencySummary summarize_latencies(std::vector<double>& micros, double seconds);
+
+// Serves float model files to processes on this host over a Unix domain socket.
+// Each connection has one request in flight at a time. Requests for the same model
+// from all connections queue up and run together through one predict_batch, as soon
+// as max_batch are waiting, every open connection is waiting (so no other request
+// can arrive), or the oldest has waited max_latency. A request thus waits at most
+// max_latency, and under load the batches fill up and every pass over the weights
+// is shared by up to max_batch requests.
+//
+// With a reload_interval, every model file is watched (see ModelFileWatcher) and a
+// new version is served from the next batch on, without stopping; batches already
+// running finish on the version they started with. A new version must keep the
+// model's input and output sizes, otherwise the old one stays.
+class InferenceServer {
+public:
+    struct Options {
+        size_t max_batch = 64;
+        std::chrono::microseconds max_latency{200};
+        // Zero serves each file as it was at startup.
+        std::chrono::milliseconds reload_interval{0};
+        // Called on a watcher thread after every reload attempt of model `model`, with
+        // the version now served, or with 0 and the error.
+        std::function<void(size_t model, uint64_t version, const char* error)> on_reload;
+    };
+
+    struct Stats {
+        // From a request being queued to its outputs being ready.
+        LatencySummary latency;
+        size_t batches = 0;
+        double mean_batch() const { return batches ? double(latency.requests) / batches : 0.0; }
+    };
+
+    // Maps every model file (see MappedPerceptrone<float>); requests name a model by
+    // its index in `model_files`. Replaces a stale socket file at `socket_path`.
+    InferenceServer(const std::string& socket_path, const std::vector<std::string>& model_files,
+                    Options options);
+    InferenceServer(const std::string& socket_path, const std::vector<std::string>& model_files)
+        : InferenceServer(socket_path, model_files, Options()) {}
+    // Stops, see stop().
+    ~InferenceServer();
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // Stops accepting, closes every connection after its current request is answered,
+    // and removes the socket file.
+    void stop();
+
+    size_t model_count() const { return batchers.size(); }
+    // The version of model `index` being served now.
+    std::shared_ptr<const MappedPerceptrone<float>> model(size_t index) const;
+
+    // Since the previous call, or since the server started.
+    Stats take_stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Pending;
+    struct Batcher;
+    struct Connection;
+
+    void accept_loop();
+    void serve(Connection& connection);
+    void run_batches(Batcher& batcher);
+    void reap_connections(bool all);
+    void wake_batchers();
+
+    std::string socketPath;
+    Options options;
+    std::vector<std::unique_ptr<Batcher>> batchers;
+
+    int listenFd = -1;
+    std::atomic<bool> stopping{false};
+    std::thread acceptThread;
+    std::mutex connectionsMutex;
+    std::list<Connection> connections;
+    // A batch goes out early once every open connection has a request queued.
+    std::atomic<size_t> openConnections{0};
+    std::atomic<size_t> queuedRequests{0};
+
+    std::mutex statsMutex;
+    std::vector<double> latencies;
+    size_t batches = 0;
+    Clock::time_point windowStart;
+};
+
+// One connection to an InferenceServer. Not thread safe: give each thread its own.
+class InferenceClient {
+public:
+    struct Shape {
+        size_t inputs;
+        size_t outputs;
+    };
+
+    explicit InferenceClient(const std::string& socket_path);
+    ~InferenceClient();
+
+    InferenceClient(const InferenceClient&) = delete;
+    InferenceClient& operator=(const InferenceClient&) = delete;
+
+    Shape describe(uint32_t model);
+    // Writes the model's outputs, of which `output` must hold describe(model).outputs.
+    // Throws if the server rejects the request.
+    void predict(uint32_t model, const float* input, size_t inputs, float* output, size_t outputs);
+
+private:
+    inference_protocol::Response exchange(uint32_t model, const float* input, size_t inputs);
+
+    int fd = -1;
+};
+
+#endif
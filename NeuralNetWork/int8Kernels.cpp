@@ -0,0 +1,57 @@
+#include "int8Kernels.h"
+#include "int8KernelsImpl.hpp"
+
+namespace {
+
+struct ScalarDot {
+    static void rows(const int8_t* w, size_t stride, size_t rows,
+                     const uint8_t* q, int32_t* acc) {
+        for (size_t n = 0; n < rows; n++) {
+            const int8_t* row = w + n * stride;
+            int32_t sum = 0;
+            for (size_t k = 0; k < stride; k++) {
+                sum += int32_t(row[k]) * int32_t(q[k]);
+            }
+            acc[n] = sum;
+        }
+    }
+};
+
+constexpr Int8Kernels scalar_kernels = Int8Impl<ScalarDot>::table("scalar");
+
+bool cpu_has_avx512bw() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512bw");
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_avx512vnni() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512vnni");
+#else
+    return false;
+#endif
+}
+
+}
+
+const Int8Kernels& int8_kernels(SimdIsa isa) {
+    if (isa > detect_simd_isa()) isa = detect_simd_isa();
+
+    const Int8Kernels* table = nullptr;
+    if (isa >= SimdIsa::AVX512 && cpu_has_avx512bw()) {
+        if (cpu_has_avx512vnni()) table = int8_detail::avx512vnni_kernels();
+        if (!table) table = int8_detail::avx512bw_kernels();
+    }
+    if (!table && isa >= SimdIsa::AVX2) table = int8_detail::avx2_kernels();
+    return table ? *table : scalar_kernels;
+}
+
+const Int8Kernels& int8_kernels() {
+    static const Int8Kernels& table = int8_kernels(selected_simd_isa());
+    return table;
+}
@@ -0,0 +1,53 @@
+#ifndef INT8_KERNELS_H
+#define INT8_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "simdKernels.h"
+
+// One quantized layer. Weights are symmetric int8 rows of `stride` bytes, a multiple
+// of MLP_ALIGNMENT, zero padded; the row count and the scales, row_sums and bias
+// arrays are padded with zeros to padded_size<float>(outputs).
+struct Int8Layer {
+    const int8_t* weights;
+    size_t stride;
+    size_t outputs;
+    const float* scales;
+    // Sum of each weight row, to remove the input zero point from the dot product.
+    const int32_t* row_sums;
+    const float* bias;
+};
+
+// Quantized forward-pass kernels. Activations are quantized to unsigned 7-bit values
+// so pmaddubsw pairs cannot saturate; every variant therefore computes exactly the
+// same integer dot products. The float steps around them match bit for bit between
+// scalar and avx2, and between the two AVX-512 variants, which contract to FMA.
+struct Int8Kernels {
+    using Function = Activator<float>::Function;
+    using Parameters = Activator<float>::Parameters;
+
+    const char* name;
+
+    // Maps x[0..n) onto [0, 127] with a scale and zero point covering
+    // [min(x, 0), max(x, 0)] and returns the scale. n is a multiple of
+    // MLP_ALIGNMENT / sizeof(float).
+    float (*quantize)(const float* x, size_t n, uint8_t* q, int32_t& zero_point);
+
+    // y[n] = f(bias[n] + scales[n] * x_scale * (W[n] . q - zero_point * row_sums[n]))
+    // for the padded row count; padding outputs are set to zero.
+    void (*gemv)(const Int8Layer& layer, const uint8_t* q, float x_scale, int32_t zero_point,
+                 float* y, Function f, const Parameters& p);
+};
+
+// Best variant for selected_simd_isa(): avx512-vnni, avx512bw, avx2 or scalar.
+const Int8Kernels& int8_kernels();
+const Int8Kernels& int8_kernels(SimdIsa isa);
+
+namespace int8_detail {
+    // Defined by the per-ISA translation units; nullptr when the ISA is not built.
+    const Int8Kernels* avx2_kernels();
+    const Int8Kernels* avx512bw_kernels();
+    const Int8Kernels* avx512vnni_kernels();
+}
+
+#endif
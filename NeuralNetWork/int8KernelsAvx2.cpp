@@ -0,0 +1,52 @@
+#include "int8Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <algorithm>
+#include <immintrin.h>
+#pragma GCC target("avx2")
+#include "int8KernelsImpl.hpp"
+
+namespace {
+
+// Sums of the lanes of a0..a3, in that order.
+__m128i reduce4(__m256i a0, __m256i a1, __m256i a2, __m256i a3) {
+    __m256i h = _mm256_hadd_epi32(_mm256_hadd_epi32(a0, a1), _mm256_hadd_epi32(a2, a3));
+    return _mm_add_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+}
+
+// u8 x s8 products summed in pairs to int16 (pmaddubsw), then to int32 (pmaddwd).
+__m256i dot32(__m256i x, const int8_t* w, __m256i ones) {
+    const __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w));
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(x, wv), ones);
+}
+
+struct Avx2Dot {
+    static void rows(const int8_t* w, size_t stride, size_t rows,
+                     const uint8_t* q, int32_t* acc) {
+        const __m256i ones = _mm256_set1_epi16(1);
+        for (size_t n = 0; n < rows; n += 4) {
+            const int8_t* w0 = w + n * stride;
+            __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+            for (size_t k = 0; k < stride; k += 32) {
+                const __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + k));
+                a0 = _mm256_add_epi32(a0, dot32(xv, w0 + k, ones));
+                a1 = _mm256_add_epi32(a1, dot32(xv, w0 + stride + k, ones));
+                a2 = _mm256_add_epi32(a2, dot32(xv, w0 + 2 * stride + k, ones));
+                a3 = _mm256_add_epi32(a3, dot32(xv, w0 + 3 * stride + k, ones));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + n), reduce4(a0, a1, a2, a3));
+        }
+    }
+};
+
+constexpr Int8Kernels avx2_table = Int8Impl<Avx2Dot>::table("avx2");
+
+}
+
+const Int8Kernels* int8_detail::avx2_kernels() { return &avx2_table; }
+
+#else
+
+const Int8Kernels* int8_detail::avx2_kernels() { return nullptr; }
+
+#endif
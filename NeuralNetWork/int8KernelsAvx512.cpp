@@ -0,0 +1,28 @@
+#include "int8Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <algorithm>
+#include <immintrin.h>
+#pragma GCC target("avx512f,avx512bw")
+#include "int8KernelsAvx512Impl.hpp"
+
+namespace {
+
+// u8 x s8 products summed in pairs to int16 (vpmaddubsw), then to int32 (vpmaddwd).
+struct MaddubsStep {
+    static __m512i apply(__m512i a, __m512i x, __m512i w) {
+        return _mm512_add_epi32(a, _mm512_madd_epi16(_mm512_maddubs_epi16(x, w), _mm512_set1_epi16(1)));
+    }
+};
+
+constexpr Int8Kernels avx512bw_table = Int8Impl<Avx512Dot<MaddubsStep>>::table("avx512bw");
+
+}
+
+const Int8Kernels* int8_detail::avx512bw_kernels() { return &avx512bw_table; }
+
+#else
+
+const Int8Kernels* int8_detail::avx512bw_kernels() { return nullptr; }
+
+#endif
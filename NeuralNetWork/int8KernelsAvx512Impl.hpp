@@ -0,0 +1,42 @@
+// Shared row loop of the AVX-512 int8 kernels. int8KernelsAvx512.cpp and
+// int8KernelsVnni.cpp include this after selecting their target ISA, so it must
+// stay in the anonymous namespace.
+#ifndef INT8_KERNELS_AVX512_IMPL_HPP
+#define INT8_KERNELS_AVX512_IMPL_HPP
+
+#include "int8KernelsImpl.hpp"
+
+namespace {
+
+// Sums of the lanes of a0..a3, in that order. Cheaper than four separate reductions.
+inline __m128i reduce4(__m512i a0, __m512i a1, __m512i a2, __m512i a3) {
+    __m512i t0 = _mm512_add_epi32(_mm512_unpacklo_epi32(a0, a1), _mm512_unpackhi_epi32(a0, a1));
+    __m512i t1 = _mm512_add_epi32(_mm512_unpacklo_epi32(a2, a3), _mm512_unpackhi_epi32(a2, a3));
+    __m512i u = _mm512_add_epi32(_mm512_unpacklo_epi64(t0, t1), _mm512_unpackhi_epi64(t0, t1));
+    __m256i h = _mm256_add_epi32(_mm512_castsi512_si256(u), _mm512_extracti64x4_epi64(u, 1));
+    return _mm_add_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+}
+
+// Step::apply(acc, x, w) adds the int32 dot products of 64 u8/s8 pairs into acc lanes.
+template<typename Step>
+struct Avx512Dot {
+    static void rows(const int8_t* w, size_t stride, size_t rows,
+                     const uint8_t* q, int32_t* acc) {
+        for (size_t n = 0; n < rows; n += 4) {
+            const int8_t* w0 = w + n * stride;
+            __m512i a0 = _mm512_setzero_si512(), a1 = a0, a2 = a0, a3 = a0;
+            for (size_t k = 0; k < stride; k += 64) {
+                const __m512i xv = _mm512_loadu_si512(q + k);
+                a0 = Step::apply(a0, xv, _mm512_loadu_si512(w0 + k));
+                a1 = Step::apply(a1, xv, _mm512_loadu_si512(w0 + stride + k));
+                a2 = Step::apply(a2, xv, _mm512_loadu_si512(w0 + 2 * stride + k));
+                a3 = Step::apply(a3, xv, _mm512_loadu_si512(w0 + 3 * stride + k));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + n), reduce4(a0, a1, a2, a3));
+        }
+    }
+};
+
+}
+
+#endif
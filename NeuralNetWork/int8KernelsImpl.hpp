@@ -0,0 +1,82 @@
+// Shared body of the int8 kernels. Each int8Kernels*.cpp includes this after
+// selecting its target ISA and instantiates Int8Impl with its dot product, so
+// everything here must stay in the anonymous namespace.
+#ifndef INT8_KERNELS_IMPL_HPP
+#define INT8_KERNELS_IMPL_HPP
+
+#include <algorithm>
+#include "int8Kernels.h"
+
+namespace {
+
+// Dot::rows(w, stride, rows, q, acc) sets acc[r] = W[r] . q for r < rows, rows a
+// multiple of 4. The float loops below run over fixed blocks so they vectorize.
+template<typename Dot>
+struct Int8Impl {
+    using Function = Int8Kernels::Function;
+    using Parameters = Int8Kernels::Parameters;
+
+    static constexpr size_t block = MLP_ALIGNMENT / sizeof(float);
+
+    static float quantize(const float* x, size_t n, uint8_t* q, int32_t& zero_point) {
+        float lo[block] = {}, hi[block] = {};
+        for (size_t i = 0; i < n; i += block) {
+            for (size_t j = 0; j < block; j++) {
+                lo[j] = std::min(lo[j], x[i + j]);
+                hi[j] = std::max(hi[j], x[i + j]);
+            }
+        }
+        for (size_t j = 1; j < block; j++) {
+            lo[0] = std::min(lo[0], lo[j]);
+            hi[0] = std::max(hi[0], hi[j]);
+        }
+
+        float scale = (hi[0] - lo[0]) / 127.0f;
+        if (!(scale > 0.0f)) scale = 1.0f;
+        const float inv_scale = 1.0f / scale;
+        zero_point = std::min(127, static_cast<int32_t>(-lo[0] * inv_scale + 0.5f));
+
+        // Clamping before the truncating conversion rounds half up.
+        const float offset = static_cast<float>(zero_point) + 0.5f;
+        for (size_t i = 0; i < n; i += block) {
+            for (size_t j = 0; j < block; j++) {
+                float v = std::max(0.0f, std::min(127.0f, x[i + j] * inv_scale + offset));
+                q[i + j] = static_cast<uint8_t>(static_cast<int32_t>(v));
+            }
+        }
+        return scale;
+    }
+
+    static void gemv(const Int8Layer& layer, const uint8_t* q, float x_scale, int32_t zero_point,
+                     float* y, Function f, const Parameters& p) {
+        alignas(MLP_ALIGNMENT) int32_t acc[block];
+        for (size_t start = 0; start < layer.outputs; start += block) {
+            Dot::rows(layer.weights + start * layer.stride, layer.stride, block, q, acc);
+
+            const float* scales = layer.scales + start;
+            const int32_t* row_sums = layer.row_sums + start;
+            const float* bias = layer.bias + start;
+            float* out = y + start;
+            for (size_t j = 0; j < block; j++) {
+                const int32_t dot = acc[j] - zero_point * row_sums[j];
+                out[j] = bias[j] + static_cast<float>(dot) * (scales[j] * x_scale);
+            }
+            Activator<float>::visit(f, p, [out](auto fn) {
+                for (size_t j = 0; j < block; j++) {
+                    out[j] = fn(out[j]);
+                }
+            });
+        }
+
+        const size_t padded = padded_size<float>(layer.outputs);
+        std::fill(y + layer.outputs, y + padded, 0.0f);
+    }
+
+    static constexpr Int8Kernels table(const char* name) {
+        return {name, &quantize, &gemv};
+    }
+};
+
+}
+
+#endif
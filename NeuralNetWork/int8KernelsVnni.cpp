@@ -0,0 +1,27 @@
+#include "int8Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <algorithm>
+#include <immintrin.h>
+#pragma GCC target("avx512f,avx512bw,avx512vnni")
+#include "int8KernelsAvx512Impl.hpp"
+
+namespace {
+
+struct DpbusdStep {
+    static __m512i apply(__m512i a, __m512i x, __m512i w) {
+        return _mm512_dpbusd_epi32(a, x, w);
+    }
+};
+
+constexpr Int8Kernels avx512vnni_table = Int8Impl<Avx512Dot<DpbusdStep>>::table("avx512vnni");
+
+}
+
+const Int8Kernels* int8_detail::avx512vnni_kernels() { return &avx512vnni_table; }
+
+#else
+
+const Int8Kernels* int8_detail::avx512vnni_kernels() { return nullptr; }
+
+#endif
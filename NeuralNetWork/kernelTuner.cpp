@@ -0,0 +1,203 @@
+#include "kernelTuner.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <utility>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+namespace {
+
+// Every candidate is timed this many times, interleaved with the others, and
+// keeps its best; each time runs passes for at least `sample` and `min_passes`.
+constexpr int repeats = 5;
+constexpr std::chrono::microseconds sample(1000);
+constexpr size_t min_passes = 8;
+// A candidate replaces the default only when it is this much faster, so noise
+// does not flip picks between runs.
+constexpr double margin = 0.97;
+
+template<typename T, typename Storage>
+std::string types_name() {
+    return std::string(value_type_name(value_type_of<T>())) + "/" + value_type_name(value_type_of<Storage>());
+}
+
+std::string shape_key(const std::string& types, ThreadPool* pool, size_t inputs, size_t outputs) {
+    std::ostringstream key;
+    key << cpu_model_name() << '\t' << types << '\t' << simd_isa_name(selected_simd_isa()) << '\t'
+        << (pool ? pool->size() : 1) << '\t' << inputs << 'x' << outputs;
+    return key.str();
+}
+
+SimdIsa isa_from_name(const std::string& name) {
+    for (SimdIsa isa : {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2, SimdIsa::AVX512}) {
+        if (name == simd_isa_name(isa)) return isa;
+    }
+    throw std::runtime_error("Unknown instruction set in kernel tuning cache: " + name);
+}
+
+}
+
+std::string cpu_model_name() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int max_leaf = __get_cpuid_max(0x80000000u, nullptr);
+    if (max_leaf >= 0x80000004u) {
+        unsigned int regs[12];
+        for (unsigned int i = 0; i < 3; i++) {
+            __get_cpuid(0x80000002u + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+        }
+        std::string name(reinterpret_cast<const char*>(regs), sizeof(regs));
+        name = name.substr(0, name.find('\0'));
+        const size_t first = name.find_first_not_of(' ');
+        const size_t last = name.find_last_not_of(' ');
+        if (first != std::string::npos) return name.substr(first, last - first + 1);
+    }
+#endif
+    return "unknown";
+}
+
+template<typename T, typename Storage>
+TunedPlan tune_kernels(const Perceptrone<T, Storage>& model, ThreadPool* pool) {
+    using Clock = std::chrono::steady_clock;
+    const std::vector<size_t>& sizes = model.get_sizes();
+    Perceptrone<T, Storage> probe = model;
+    probe.set_thread_pool(pool);
+    auto ws = probe.make_workspace();
+    std::vector<T> input(sizes.front()), output(sizes.back());
+    RandomStream(0).fill_uniform(input.data(), input.size(), T(-1), T(1));
+
+    auto pass_ns = [&] {
+        size_t calls = 0;
+        const auto start = Clock::now();
+        Clock::duration elapsed;
+        do {
+            probe.predict_into(ws, input.data(), output.data());
+            calls++;
+            elapsed = Clock::now() - start;
+        } while (elapsed < sample || calls < min_passes);
+        return std::chrono::duration<double, std::nano>(elapsed).count() / double(calls);
+    };
+    // Best time of each plan, timed in turns.
+    auto time_plans = [&](const std::vector<std::vector<LayerKernelChoice>>& plans) {
+        std::vector<double> times(plans.size(), std::numeric_limits<double>::infinity());
+        for (int r = 0; r < repeats; r++) {
+            for (size_t c = 0; c < plans.size(); c++) {
+                probe.set_kernel_plan(plans[c]);
+                times[c] = std::min(times[c], pass_ns());
+            }
+        }
+        return times;
+    };
+
+    const std::vector<LayerKernelChoice> defaults = probe.get_kernel_plan();
+    std::vector<SimdIsa> isas;
+    for (SimdIsa isa : {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2, SimdIsa::AVX512}) {
+        if (isa <= selected_simd_isa() && simd_kernels<T, Storage>(isa).isa == isa) isas.push_back(isa);
+    }
+    const bool can_thread = pool && pool->size() > 1;
+
+    std::vector<LayerKernelChoice> plan = defaults;
+    std::map<std::pair<size_t, size_t>, LayerKernelChoice> shapes;
+    for (size_t l = 0; l < plan.size(); l++) {
+        const auto shape = std::make_pair(sizes[l], sizes[l + 1]);
+        const auto known = shapes.find(shape);
+        if (known != shapes.end()) {
+            plan[l] = known->second;
+            continue;
+        }
+
+        // The default comes first, the fallback when nothing beats it by the margin.
+        std::vector<std::vector<LayerKernelChoice>> candidates = {plan};
+        for (bool threaded : {false, true}) {
+            for (SimdIsa isa : isas) {
+                if (threaded && !can_thread) continue;
+                if (isa == defaults[l].isa && threaded == defaults[l].threaded) continue;
+                candidates.push_back(plan);
+                candidates.back()[l] = {isa, threaded};
+            }
+        }
+        const std::vector<double> times = time_plans(candidates);
+        size_t best = 0;
+        for (size_t c = 1; c < candidates.size(); c++) {
+            if (times[c] < times[best] * margin) best = c;
+        }
+        plan[l] = candidates[best][l];
+        shapes[shape] = plan[l];
+    }
+
+    const std::vector<double> times = time_plans({defaults, plan});
+    if (!(times[1] < times[0] * margin)) plan = defaults;
+    return {plan, std::min(times[0], times[1]), times[0]};
+}
+
+KernelTuningCache::KernelTuningCache(const std::string& filename) : filename(filename) {
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        for (std::string field; std::getline(stream, field, '\t');) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 7 || (fields[6] != "0" && fields[6] != "1")) {
+            throw std::runtime_error("Malformed kernel tuning cache line: " + line);
+        }
+        std::string key = fields[0];
+        for (size_t i = 1; i < 5; i++) key += '\t' + fields[i];
+        entries[key] = {isa_from_name(fields[5]), fields[6] == "1"};
+    }
+}
+
+template<typename T, typename Storage>
+std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<T, Storage>& model, ThreadPool* pool) {
+    const std::vector<size_t>& sizes = model.get_sizes();
+    const std::string types = types_name<T, Storage>();
+    std::vector<std::string> keys;
+    bool missing = false;
+    for (size_t l = 0; l + 1 < sizes.size(); l++) {
+        keys.push_back(shape_key(types, pool, sizes[l], sizes[l + 1]));
+        missing = missing || entries.count(keys.back()) == 0;
+    }
+
+    if (missing) {
+        const TunedPlan tuned = tune_kernels(model, pool);
+        for (size_t l = 0; l < keys.size(); l++) {
+            if (entries.emplace(keys[l], tuned.plan[l]).second) tunedShapes++;
+        }
+        save();
+    }
+
+    std::vector<LayerKernelChoice> plan;
+    for (const std::string& key : keys) {
+        plan.push_back(entries.at(key));
+    }
+    return plan;
+}
+
+void KernelTuningCache::save() const {
+    std::ofstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for writing");
+    }
+    file << "# cpu\ttypes\tisa cap\tthreads\tshape\tisa\tthreaded\n";
+    for (const auto& entry : entries) {
+        file << entry.first << '\t' << simd_isa_name(entry.second.isa) << '\t'
+             << (entry.second.threaded ? 1 : 0) << '\n';
+    }
+    if (!file) {
+        throw std::runtime_error("Failed to write kernel tuning cache");
+    }
+}
+
+template TunedPlan tune_kernels(const Perceptrone<float>&, ThreadPool*);
+template TunedPlan tune_kernels(const Perceptrone<double>&, ThreadPool*);
+template TunedPlan tune_kernels(const Perceptrone<float, float16>&, ThreadPool*);
+template TunedPlan tune_kernels(const Perceptrone<float, bfloat16>&, ThreadPool*);
+template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<float>&, ThreadPool*);
+template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<double>&, ThreadPool*);
+template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<float, float16>&, ThreadPool*);
+template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<float, bfloat16>&, ThreadPool*);
@@ -0,0 +1,68 @@
+#ifndef KERNEL_TUNER_H
+#define KERNEL_TUNER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Perceptrone.h"
+
+// Picks the kernels of each layer of a Perceptrone by timing them on this host,
+// and remembers the picks in a small text file so later runs skip the timing.
+//
+// The candidates of a layer are every instruction set the CPU supports up to
+// selected_simd_isa(), so MLP_ISA still caps them, each run on the calling thread
+// and, given a pool, split across it. Candidates are timed as single-input
+// forward passes of a copy of the model in which only that layer changes, so they
+// run in place with realistic caches. Layers are tuned in order, starting from
+// the model's defaults, each against the picks already made for the ones before it.
+
+// Picks for every layer, and a forward pass with them and with the defaults, timed
+// alternately at the end. When the picks are not faster the plan is the defaults.
+struct TunedPlan {
+    std::vector<LayerKernelChoice> plan;
+    double pass_ns = 0.0;
+    double default_pass_ns = 0.0;
+};
+
+// CPU brand string, e.g. "Intel(R) Xeon(R) ...", or "unknown".
+std::string cpu_model_name();
+
+// Tunes every layer of `model`. Layers of the same shape get the pick of the first
+// one. `pool` may be nullptr, which leaves every layer on the calling thread.
+template<typename T, typename Storage>
+TunedPlan tune_kernels(const Perceptrone<T, Storage>& model, ThreadPool* pool);
+
+// Tuned picks keyed by CPU model, value types, MLP_ISA cap, pool size and layer
+// shape, one per line:
+//   <cpu> \t <types> \t <isa cap> \t <threads> \t <inputs>x<outputs> \t <isa> \t <threaded>
+class KernelTuningCache {
+public:
+    // Reads `filename` if it exists; throws std::runtime_error if it is malformed.
+    explicit KernelTuningCache(const std::string& filename);
+
+    // A kernel plan for `model` (Perceptrone::set_kernel_plan) on this host and
+    // `pool`. Shapes missing from the cache are tuned and the file is rewritten.
+    template<typename T, typename Storage>
+    std::vector<LayerKernelChoice> plan(const Perceptrone<T, Storage>& model, ThreadPool* pool);
+
+    // Shapes tuned by plan() rather than read from the file.
+    size_t tuned_shapes() const { return tunedShapes; }
+
+    void save() const;
+
+private:
+    std::string filename;
+    std::map<std::string, LayerKernelChoice> entries;
+    size_t tunedShapes = 0;
+};
+
+extern template TunedPlan tune_kernels(const Perceptrone<float>&, ThreadPool*);
+extern template TunedPlan tune_kernels(const Perceptrone<double>&, ThreadPool*);
+extern template TunedPlan tune_kernels(const Perceptrone<float, float16>&, ThreadPool*);
+extern template TunedPlan tune_kernels(const Perceptrone<float, bfloat16>&, ThreadPool*);
+extern template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<float>&, ThreadPool*);
+extern template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<double>&, ThreadPool*);
+extern template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<float, float16>&, ThreadPool*);
+extern template std::vector<LayerKernelChoice> KernelTuningCache::plan(const Perceptrone<float, bfloat16>&, ThreadPool*);
+
+#endif
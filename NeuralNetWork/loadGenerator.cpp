@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "inferenceServer.h"
+#include "randomStream.h"
+
+using namespace std;
+
+// MLPLoadGen <socket> [--model I] [--clients N] [--seconds S]
+// MLPLoadGen --serve [model.mlp] [--clients N] [--seconds S] [--max-batch N] [--max-latency-us U]
+// Keeps N connections (default 16) busy with one request each for S seconds
+// (default 3) and prints round-trip p50, p99 and throughput. With --serve it runs
+// its own InferenceServer on a temporary socket, first without batching and then
+// with the given options, on the model file or on a random 256-512-512-16 model.
+struct LoadOptions {
+    uint32_t model = 0;
+    size_t clients = 16;
+    double seconds = 3.0;
+};
+
+LatencySummary run_load(const string& socket, const LoadOptions& load) {
+    vector<vector<double>> latencies(load.clients);
+    vector<thread> clients;
+    atomic<bool> failed{false};
+    const auto start = chrono::steady_clock::now();
+    const auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                      chrono::duration<double>(load.seconds));
+
+    for (size_t c = 0; c < load.clients; c++) {
+        clients.emplace_back([&, c] {
+            try {
+                InferenceClient client(socket);
+                const InferenceClient::Shape shape = client.describe(load.model);
+                vector<float> input(shape.inputs), output(shape.outputs);
+                RandomStream(1, c).fill_uniform(input.data(), input.size(), -1.0f, 1.0f);
+
+                for (auto now = chrono::steady_clock::now(); now < deadline;) {
+                    client.predict(load.model, input.data(), input.size(), output.data(), output.size());
+                    const auto after = chrono::steady_clock::now();
+                    latencies[c].push_back(chrono::duration<double, micro>(after - now).count());
+                    now = after;
+                }
+            } catch (const exception& e) {
+                if (!failed.exchange(true)) fprintf(stderr, "%s\n", e.what());
+            }
+        });
+    }
+    for (auto& client : clients) client.join();
+    if (failed) throw runtime_error("Load generator client failed");
+
+    vector<double> all;
+    for (const auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    return summarize_latencies(all, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+}
+
+void print_summary(const char* label, const LatencySummary& l) {
+    printf("%s: %.0f запросов/с, p50 %.0f мкс, p99 %.0f мкс\n",
+           label, l.requests_per_second(), l.p50_us, l.p99_us);
+}
+
+int main(int argc, char** argv) {
+    LoadOptions load;
+    InferenceServer::Options options;
+    bool serve = false;
+    string target;
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--serve") == 0) {
+            serve = true;
+        } else if (strcmp(argv[i], "--model") == 0 && has_value) {
+            load.model = uint32_t(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--clients") == 0 && has_value) {
+            load.clients = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--seconds") == 0 && has_value) {
+            load.seconds = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--max-batch") == 0 && has_value) {
+            options.max_batch = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--max-latency-us") == 0 && has_value) {
+            options.max_latency = chrono::microseconds(strtol(argv[++i], nullptr, 10));
+        } else if (target.empty() && argv[i][0] != '-') {
+            target = argv[i];
+        } else {
+            target.clear();
+            serve = false;
+            break;
+        }
+    }
+    if ((!serve && target.empty()) || load.clients == 0) {
+        fprintf(stderr, "Использование: %s <сокет> [--model I] [--clients N] [--seconds S]\n"
+                        "               %s --serve [модель.mlp] [--clients N] [--seconds S] "
+                        "[--max-batch N] [--max-latency-us U]\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    try {
+        if (!serve) {
+            print_summary("Клиенты", run_load(target, load));
+            return 0;
+        }
+
+        const string pid = to_string(getpid());
+        const string socket = "/tmp/mlp_loadgen_" + pid + ".sock";
+        string model = target;
+        if (model.empty()) {
+            model = "/tmp/mlp_loadgen_" + pid + ".mlp";
+            Perceptrone<float>({256, 512, 512, 16},
+                               {Activator<float>::RELU, Activator<float>::RELU, Activator<float>::IDENTITY},
+                               0.1f).save(model);
+        }
+        load.model = 0;
+
+        printf("Клиентов %zu, %.1f с на режим\n", load.clients, load.seconds);
+        InferenceServer::Options single = options;
+        single.max_batch = 1;
+        for (const InferenceServer::Options& mode : {single, options}) {
+            InferenceServer server(socket, {model}, mode);
+            const LatencySummary round_trip = run_load(socket, load);
+            const InferenceServer::Stats stats = server.take_stats();
+            char label[32];
+            snprintf(label, sizeof(label), "Пакет до %zu", mode.max_batch);
+            print_summary(label, round_trip);
+            printf("    средний пакет %.1f, на сервере p50 %.0f мкс, p99 %.0f мкс\n",
+                   stats.mean_batch(), stats.latency.p50_us, stats.latency.p99_us);
+        }
+        if (target.empty()) remove(model.c_str());
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
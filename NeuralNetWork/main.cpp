@@ -3,6 +3,8 @@
 #include <cmath>
 #include "backpropagation.h"
 #include "exec_time.h"
+#include "allocationCounter.h"
+#include "quantizedPerceptrone.h"
 
 using namespace std;
 
@@ -76,10 +78,16 @@ void quadratic_example()
     cout << "Результаты после обучения:" << endl;
     cout << "x   Сеть   Мат. Разность" << endl;
 
+    vector<T> batch;
+    for (const auto& input : inputs) {
+        auto normalized = normalize<T>(input);
+        batch.insert(batch.end(), normalized.begin(), normalized.end());
+    }
+
     AppExecutionTimeCounter::StartMeasurement();
+    auto outputs = denormalize<T>(mlp.predict_batch(batch, inputs.size()));
     for (int x = 0; x <= xx; x++) {
-        auto output = denormalize<T>(mlp.predict(normalize<T>({T(x)})));
-        T predicted = round(output[0]);
+        T predicted = round(outputs[x]);
         T actual = T(x*x);
         printf("%3d %5.0f %5.0f\t%2.0f\n", 
                x, 
@@ -91,7 +99,21 @@ void quadratic_example()
     double predictTimeSeconds = AppExecutionTimeCounter::EndMeasurement();
     printf("Время вычислений (мсек.): %1.3lf\n", predictTimeSeconds * 1000.0);
 
-    mlp.save_weights("quadratic_weights.bin");
+    if (AllocationCounter::enabled) {
+        T output = T(0);
+        AllocationCounter counter;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            mlp.predict_into(&batch[i], &output);
+        }
+        printf("Выделений памяти в predict_into: %zu\n", counter.count());
+    }
+
+    QuantizedPerceptrone quantized(mlp);
+    QuantizationReport report = quantized.compare(mlp, batch.data(), inputs.size());
+    printf("INT8 (%s): макс. ошибка %1.4lf, средняя ошибка %1.4lf\n",
+           quantized.kernel_name(), report.max_abs_error * 10.0, report.mean_abs_error * 10.0);
+
+    mlp.save("quadratic.mlp");
 }
 
 int main() {
@@ -0,0 +1,53 @@
+#include "mappedFile.h"
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open file for reading");
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("Unexpected weights file size");
+    }
+    length = static_cast<size_t>(info.st_size);
+    address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        address = nullptr;
+        length = 0;
+        throw std::runtime_error("Cannot map weights file");
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (address) ::munmap(address, length);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string&) {
+    throw std::runtime_error("Memory-mapped files are not supported on this platform");
+}
+
+MappedFile::~MappedFile() {}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : address(std::exchange(other.address, nullptr)),
+      length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    std::swap(address, other.address);
+    std::swap(length, other.length);
+    return *this;
+}
@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only shared mapping of a whole file. Pages are read on first touch and live in
+// the page cache, so every process mapping the same file shares one copy. The file
+// must not be truncated while mapped: touching a page past the new end raises SIGBUS.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Page aligned, so any offset that is a multiple of MLP_ALIGNMENT is aligned too.
+    const unsigned char* data() const { return static_cast<const unsigned char*>(address); }
+    size_t size() const { return length; }
+
+private:
+    void* address = nullptr;
+    size_t length = 0;
+};
+
+#endif
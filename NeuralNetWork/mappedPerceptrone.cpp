@@ -0,0 +1,116 @@
+#include "mappedPerceptrone.h"
+
+template<typename T, typename Storage>
+MappedPerceptrone<T, Storage>::Workspace::Workspace(const MappedPerceptrone& model) : sizes(model.sizes) {
+    data.resize(model.sizes.size());
+    for (size_t i = 0; i < model.sizes.size(); ++i) {
+        data[i].assign(padded_size<T>(model.sizes[i]), T(0));
+    }
+}
+
+template<typename T, typename Storage>
+void MappedPerceptrone<T, Storage>::check_workspace(const Workspace& ws) const {
+    if (ws.sizes != sizes) {
+        throw std::invalid_argument("Workspace does not match network structure");
+    }
+}
+
+template<typename T, typename Storage>
+MappedPerceptrone<T, Storage>::MappedPerceptrone(const std::string& filename, bool verify_checksum)
+    : file(filename),
+      kernels(&simd_kernels<T, Storage>()) {
+    const ModelHeader header = parse_model_header(file.data(), file.size());
+    if (header.compute_type != value_type_of<T>() || header.storage_type != value_type_of<Storage>()) {
+        throw std::runtime_error("Weights file value type mismatch");
+    }
+    if (verify_checksum && crc32(file.data() + header.header_bytes(),
+                                 file.size() - header.header_bytes()) != header.payload_crc) {
+        throw std::runtime_error("Model file checksum mismatch");
+    }
+
+    std::vector<typename Activator<T>::Function> functions;
+    for (uint32_t f : header.activations) {
+        functions.push_back(typename Activator<T>::Function(f));
+    }
+    activations = Activator<T>(functions).getFunctions();
+    activationParameters.alpha = T(header.alpha);
+    activationParameters.selu_alpha = T(header.selu_alpha);
+    activationParameters.selu_scale = T(header.selu_scale);
+
+    sizes = header.sizes;
+    for (size_t l = 0; l + 1 < sizes.size(); l++) {
+        const size_t offset = header.weight_offset(l);
+        weights.push_back(reinterpret_cast<const Storage*>(file.data() + offset));
+        bias.push_back(reinterpret_cast<const Storage*>(file.data() + offset + header.weight_bytes(l)));
+    }
+    workspace = Workspace(*this);
+}
+
+template<typename T, typename Storage>
+std::vector<T> MappedPerceptrone<T, Storage>::predict(const std::vector<T>& input) {
+    if (input.size() != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    std::vector<T> output(sizes.back());
+    predict_into(workspace, input.data(), output.data());
+    return output;
+}
+
+template<typename T, typename Storage>
+void MappedPerceptrone<T, Storage>::predict_into(const T* input, T* output) {
+    predict_into(workspace, input, output);
+}
+
+template<typename T, typename Storage>
+void MappedPerceptrone<T, Storage>::predict_into(Workspace& ws, const T* input, T* output) const {
+    check_workspace(ws);
+    auto& data = ws.data;
+    std::copy(input, input + sizes.front(), data[0].begin());
+    for (size_t l = 0; l + 1 < sizes.size(); l++) {
+        kernels->gemv(weights[l], padded_size<T>(sizes[l]), sizes[l + 1], data[l].data(), bias[l],
+                      data[l + 1].data(), activations[l], activationParameters);
+    }
+    std::copy(data.back().begin(), data.back().begin() + sizes.back(), output);
+}
+
+template<typename T, typename Storage>
+void MappedPerceptrone<T, Storage>::predict_batch(const T* input, size_t rows, size_t cols, T* output) {
+    predict_batch(workspace, input, rows, cols, output);
+}
+
+template<typename T, typename Storage>
+void MappedPerceptrone<T, Storage>::predict_batch(Workspace& ws, const T* input, size_t rows, size_t cols, T* output) const {
+    check_workspace(ws);
+    if (cols != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    if (rows > ws.batchRows) {
+        ws.batchData.resize(sizes.size());
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            ws.batchData[i].assign(rows * padded_size<T>(sizes[i]), T(0));
+        }
+        ws.batchRows = rows;
+    }
+
+    auto& data = ws.batchData;
+    const size_t in_stride = padded_size<T>(cols);
+    for (size_t row = 0; row < rows; row++) {
+        std::copy(input + row * cols, input + (row + 1) * cols, data[0].begin() + row * in_stride);
+    }
+    for (size_t l = 0; l + 1 < sizes.size(); l++) {
+        kernels->gemm(weights[l], padded_size<T>(sizes[l]), sizes[l + 1], data[l].data(), rows, bias[l],
+                      data[l + 1].data(), padded_size<T>(sizes[l + 1]), activations[l], activationParameters);
+    }
+
+    const size_t outputs = sizes.back();
+    const size_t out_stride = padded_size<T>(outputs);
+    for (size_t row = 0; row < rows; row++) {
+        const T* y = data.back().data() + row * out_stride;
+        std::copy(y, y + outputs, output + row * outputs);
+    }
+}
+
+template class MappedPerceptrone<float>;
+template class MappedPerceptrone<double>;
+template class MappedPerceptrone<float, float16>;
+template class MappedPerceptrone<float, bfloat16>;
@@ -0,0 +1,80 @@
+#ifndef MAPPED_PERCEPTRONE_H
+#define MAPPED_PERCEPTRONE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Perceptrone.h"
+#include "mappedFile.h"
+
+// Inference-only Perceptrone<T, Storage> that runs straight from a memory-mapped
+// model file (Perceptrone::save, see modelFile.h) instead of copying it into the
+// heap. Opening a model only maps the file and reads its header; weight pages come
+// in from the page cache as the first passes touch them, and are shared by every
+// process serving the same file.
+template<typename T, typename Storage = T>
+class MappedPerceptrone {
+public:
+    class Workspace {
+    public:
+        Workspace() = default;
+        explicit Workspace(const MappedPerceptrone& model);
+
+    private:
+        friend class MappedPerceptrone;
+
+        std::vector<size_t> sizes;
+        // data[layer] is padded to padded_size<T>(sizes[layer]), padding stays zero.
+        std::vector<AlignedVector<T>> data;
+        std::vector<AlignedVector<T>> batchData;
+        size_t batchRows = 0;
+    };
+
+    // Maps `filename`; throws if its header is damaged or its value types are not
+    // T and Storage. The header checksum is always checked. The payload checksum
+    // is only checked with `verify_checksum`, since that reads every page up front.
+    explicit MappedPerceptrone(const std::string& filename, bool verify_checksum = false);
+
+    Workspace make_workspace() const { return Workspace(*this); }
+
+    std::vector<T> predict(const std::vector<T>& input);
+    void predict_into(const T* input, T* output);
+    // The Workspace overloads throw std::invalid_argument if ws was made for other
+    // layer sizes.
+    void predict_into(Workspace& ws, const T* input, T* output) const;
+    void predict_batch(const T* input, size_t rows, size_t cols, T* output);
+    void predict_batch(Workspace& ws, const T* input, size_t rows, size_t cols, T* output) const;
+
+    void set_simd_isa(SimdIsa isa) { kernels = &simd_kernels<T, Storage>(isa); }
+    SimdIsa get_simd_isa() const { return kernels->isa; }
+    void set_activation_accuracy(typename Activator<T>::Accuracy accuracy) {
+        activationParameters.accuracy = accuracy;
+    }
+
+    const std::vector<size_t>& get_sizes() const { return sizes; }
+    const std::vector<typename Activator<T>::Function>& get_activations() const { return activations; }
+    LayerView<Storage> layer_weights(size_t layer) const {
+        return {weights[layer], sizes[layer], sizes[layer + 1], padded_size<T>(sizes[layer])};
+    }
+    size_t mapped_bytes() const { return file.size(); }
+
+private:
+    void check_workspace(const Workspace& ws) const;
+
+    MappedFile file;
+    std::vector<size_t> sizes;
+    // Point into `file`; weights[l] and bias[l] feed layer l + 1.
+    std::vector<const Storage*> weights;
+    std::vector<const Storage*> bias;
+    std::vector<typename Activator<T>::Function> activations;
+    typename Activator<T>::Parameters activationParameters;
+    const SimdKernels<T, Storage>* kernels;
+    Workspace workspace;
+};
+
+extern template class MappedPerceptrone<float>;
+extern template class MappedPerceptrone<double>;
+extern template class MappedPerceptrone<float, float16>;
+extern template class MappedPerceptrone<float, bfloat16>;
+
+#endif
@@ -4,8 +4,9 @@
 #include <vector>
 #include <string>
 #include <cmath>
-#include <functional>
+#include <cstddef>
 #include <stdexcept>
+#include "fastActivations.hpp"
 
 template<typename T>
 class Activator {
@@ -25,81 +26,169 @@ public:
         IDENTITY
     };
 
-    struct ActivationPair {
-        std::function<T(T)> function;
-        std::function<T(T)> derivative;
+    // How the transcendental activations (sigmoid, tanh, swish, elu, gelu, selu,
+    // softplus) are evaluated in the forward pass; see fastActivations.hpp for the
+    // error bounds. Derivatives are always exact.
+    enum Accuracy {
+        EXACT = 0,
+        FAST,
+        TABLE
     };
 
-    Activator(const std::vector<Function>& functions, 
+    struct Parameters {
+        T alpha = T(0.01);
+        T selu_alpha = T(1.67326);
+        T selu_scale = T(1.0507);
+        Accuracy accuracy = EXACT;
+    };
+
+    Activator(const std::vector<Function>& functions,
               T alpha_val = T(0.01),
               T selu_alpha_val = T(1.67326),
               T selu_scale_val = T(1.0507))
-        : alpha(alpha_val), selu_alpha(selu_alpha_val), selu_scale(selu_scale_val) 
+        : functions(functions), parameters{alpha_val, selu_alpha_val, selu_scale_val}
     {
         for (auto func : functions) {
-            switch (func) {
-                case RELU:
-                    activations.push_back(relu);
-                    derivatives.push_back(relu_derivative);
-                    break;
-                case LEAKY_RELU:
-                    activations.push_back([this](T x) { return leaky_relu(x); });
-                    derivatives.push_back([this](T x) { return leaky_relu_derivative(x); });
-                    break;
-                case SIGMOID:
-                    activations.push_back(sigmoid);
-                    derivatives.push_back(sigmoid_derivative);
-                    break;
-                case TANH:
-                    activations.push_back(tanh_activation);
-                    derivatives.push_back(tanh_derivative);
-                    break;
-                case SWISH:
-                    activations.push_back(swish);
-                    derivatives.push_back(swish_derivative);
-                    break;
-                case ELU:
-                    activations.push_back([this](T x) { return elu(x); });
-                    derivatives.push_back([this](T x) { return elu_derivative(x); });
-                    break;
-                case GELU:
-                    activations.push_back(gelu);
-                    derivatives.push_back(gelu_derivative);
-                    break;
-                case SELU:
-                    activations.push_back([this](T x) { return selu(x); });
-                    derivatives.push_back([this](T x) { return selu_derivative(x); });
-                    break;
-                case SOFTPLUS:
-                    activations.push_back(softplus);
-                    derivatives.push_back(softplus_derivative);
-                    break;
-                case SOFTSIGN:
-                    activations.push_back(softsign);
-                    derivatives.push_back(softsign_derivative);
-                    break;
-                case BINARY_STEP:
-                    activations.push_back(binary_step);
-                    derivatives.push_back(binary_step_derivative);
-                    break;
-                case IDENTITY:
-                    activations.push_back(identity);
-                    derivatives.push_back(identity_derivative);
-                    break;
-                default:
-                    throw std::invalid_argument("Unknown activation function");
+            if (func < RELU || func > IDENTITY) {
+                throw std::invalid_argument("Unknown activation function");
+            }
+        }
+    }
+
+    const std::vector<Function>& getFunctions() const { return functions; }
+    const Parameters& getParameters() const { return parameters; }
+
+    // Lower-case names as in the enum ("relu", "leaky_relu", ...), for files and tools.
+    static const char* name(Function f) {
+        static const char* const names[] = {
+            "relu", "leaky_relu", "sigmoid", "tanh", "swish", "elu",
+            "gelu", "selu", "softplus", "softsign", "binary_step", "identity"
+        };
+        if (f < RELU || f > IDENTITY) {
+            throw std::invalid_argument("Unknown activation function");
+        }
+        return names[f - RELU];
+    }
+
+    static Function from_name(const std::string& text) {
+        for (int f = RELU; f <= IDENTITY; f++) {
+            if (text == name(Function(f))) return Function(f);
+        }
+        throw std::invalid_argument("Unknown activation function: " + text);
+    }
+
+    // Calls map(fn) once with the elementwise function selected by `f` and, for the
+    // transcendental ones, p.accuracy, so the caller's loop is compiled against a
+    // direct, inlinable call.
+    template<typename Map>
+    static void visit(Function f, const Parameters& p, Map&& map) {
+        switch (f) {
+            case RELU: map([](T x) { return relu(x); }); break;
+            case LEAKY_RELU: {
+                const T a = p.alpha;
+                map([a](T x) { return leaky_relu(x, a); });
+                break;
+            }
+            case SIGMOID:
+                by_accuracy(p, map, [](T x) { return sigmoid(x); },
+                            [](T x) { return FastMath<T>::sigmoid(x); },
+                            [](const Table* t) { return [t](T x) { return t->sigmoid(x); }; });
+                break;
+            case TANH:
+                by_accuracy(p, map, [](T x) { return tanh_activation(x); },
+                            [](T x) { return FastMath<T>::tanh(x); },
+                            [](const Table* t) { return [t](T x) { return t->tanh(x); }; });
+                break;
+            case SWISH:
+                by_accuracy(p, map, [](T x) { return swish(x); },
+                            [](T x) { return FastMath<T>::swish(x); },
+                            [](const Table* t) { return [t](T x) { return t->swish(x); }; });
+                break;
+            case ELU: {
+                const T a = p.alpha;
+                by_accuracy(p, map, [a](T x) { return elu(x, a); },
+                            [a](T x) { return FastMath<T>::elu(x, a); },
+                            [a](const Table* t) { return [t, a](T x) { return t->elu(x, a); }; });
+                break;
+            }
+            case GELU:
+                by_accuracy(p, map, [](T x) { return gelu(x); },
+                            [](T x) { return FastMath<T>::gelu(x); },
+                            [](const Table* t) { return [t](T x) { return t->gelu(x); }; });
+                break;
+            case SELU: {
+                const T a = p.selu_alpha, s = p.selu_scale;
+                by_accuracy(p, map, [a, s](T x) { return selu(x, a, s); },
+                            [a, s](T x) { return FastMath<T>::selu(x, a, s); },
+                            [a, s](const Table* t) { return [t, a, s](T x) { return t->selu(x, a, s); }; });
+                break;
             }
+            case SOFTPLUS:
+                by_accuracy(p, map, [](T x) { return softplus(x); },
+                            [](T x) { return FastMath<T>::softplus(x); },
+                            [](const Table* t) { return [t](T x) { return t->softplus(x); }; });
+                break;
+            case SOFTSIGN: map([](T x) { return softsign(x); }); break;
+            case BINARY_STEP: map([](T x) { return binary_step(x); }); break;
+            case IDENTITY: map([](T x) { return identity(x); }); break;
+            default: throw std::invalid_argument("Unknown activation function");
         }
     }
 
-    const std::vector<std::function<T(T)>>& getActivations() const { return activations; }
-    const std::vector<std::function<T(T)>>& getDerivatives() const { return derivatives; }
+    template<typename Map>
+    static void visit_derivative(Function f, const Parameters& p, Map&& map) {
+        switch (f) {
+            case RELU: map([](T x) { return relu_derivative(x); }); break;
+            case LEAKY_RELU: {
+                const T a = p.alpha;
+                map([a](T x) { return leaky_relu_derivative(x, a); });
+                break;
+            }
+            case SIGMOID: map([](T x) { return sigmoid_derivative(x); }); break;
+            case TANH: map([](T x) { return tanh_derivative(x); }); break;
+            case SWISH: map([](T x) { return swish_derivative(x); }); break;
+            case ELU: {
+                const T a = p.alpha;
+                map([a](T x) { return elu_derivative(x, a); });
+                break;
+            }
+            case GELU: map([](T x) { return gelu_derivative(x); }); break;
+            case SELU: {
+                const T a = p.selu_alpha, s = p.selu_scale;
+                map([a, s](T x) { return selu_derivative(x, a, s); });
+                break;
+            }
+            case SOFTPLUS: map([](T x) { return softplus_derivative(x); }); break;
+            case SOFTSIGN: map([](T x) { return softsign_derivative(x); }); break;
+            case BINARY_STEP: map([](T x) { return binary_step_derivative(x); }); break;
+            case IDENTITY: map([](T x) { return identity_derivative(x); }); break;
+            default: throw std::invalid_argument("Unknown activation function");
+        }
+    }
+
+    // Replaces each of the n values at begin with f(value).
+    static void apply(Function f, T* begin, size_t n, const Parameters& p = Parameters()) {
+        visit(f, p, [begin, n](auto fn) {
+            for (size_t i = 0; i < n; i++) {
+                begin[i] = fn(begin[i]);
+            }
+        });
+    }
+
+    // Replaces each of the n values at begin with f'(value).
+    static void apply_derivative(Function f, T* begin, size_t n, const Parameters& p = Parameters()) {
+        visit_derivative(f, p, [begin, n](auto fn) {
+            for (size_t i = 0; i < n; i++) {
+                begin[i] = fn(begin[i]);
+            }
+        });
+    }
 
     static T relu(T x) { return x > 0 ? x : T(0); }
     static T relu_derivative(T x) { return x > 0 ? T(1) : T(0); }
 
-    T leaky_relu(T x) const { return x > 0 ? x : alpha * x; }
-    T leaky_relu_derivative(T x) const { return x > 0 ? T(1) : alpha; }
+    static T leaky_relu(T x, T alpha) { return x > 0 ? x : alpha * x; }
+    static T leaky_relu_derivative(T x, T alpha) { return x > 0 ? T(1) : alpha; }
 
     static T sigmoid(T x) { return T(1) / (T(1) + std::exp(-x)); }
     static T sigmoid_derivative(T x) {
@@ -119,26 +208,26 @@ public:
         return s + x * s * (T(1) - s);
     }
 
-    T elu(T x) const { return x >= 0 ? x : alpha * (std::exp(x) - T(1)); }
-    T elu_derivative(T x) const { return x >= 0 ? T(1) : alpha * std::exp(x); }
+    static T elu(T x, T alpha) { return x >= 0 ? x : alpha * (std::exp(x) - T(1)); }
+    static T elu_derivative(T x, T alpha) { return x >= 0 ? T(1) : alpha * std::exp(x); }
 
     static T gelu(T x) {
         const T pi = T(3.14159265358979323846);
-        return T(0.5) * x * (T(1) + std::tanh(std::sqrt(T(2) / pi) * 
+        return T(0.5) * x * (T(1) + std::tanh(std::sqrt(T(2) / pi) *
                (x + T(0.044715) * std::pow(x, T(3)))));
     }
     static T gelu_derivative(T x) {
         const T pi = T(3.14159265358979323846);
-        T cdf = T(0.5) * (T(1) + std::tanh(std::sqrt(T(2) / pi) * 
+        T cdf = T(0.5) * (T(1) + std::tanh(std::sqrt(T(2) / pi) *
                (x + T(0.044715) * std::pow(x, T(3)))));
-        return cdf + x * (T(1) / std::sqrt(T(2) * pi)) * 
+        return cdf + x * (T(1) / std::sqrt(T(2) * pi)) *
                std::exp(T(-0.5) * x * x) * (T(1) + T(0.134145) * x * x);
     }
 
-    T selu(T x) const {
+    static T selu(T x, T selu_alpha, T selu_scale) {
         return selu_scale * (x > 0 ? x : selu_alpha * (std::exp(x) - T(1)));
     }
-    T selu_derivative(T x) const {
+    static T selu_derivative(T x, T selu_alpha, T selu_scale) {
         return selu_scale * (x > 0 ? T(1) : selu_alpha * std::exp(x));
     }
 
@@ -157,12 +246,21 @@ public:
     static T identity_derivative(T x) { return T(1); }
 
 private:
-    const T alpha;
-    const T selu_alpha;
-    const T selu_scale;
-    
-    std::vector<std::function<T(T)>> activations;
-    std::vector<std::function<T(T)>> derivatives;
+    using Table = ActivationTable<T>;
+
+    // Calls map with the variant p.accuracy selects. `table` makes the TABLE variant
+    // from the tables, so they are only built once a model asks for them.
+    template<typename Map, typename Exact, typename Fast, typename MakeTable>
+    static void by_accuracy(const Parameters& p, Map& map, Exact exact, Fast fast, MakeTable table) {
+        switch (p.accuracy) {
+            case FAST: map(fast); break;
+            case TABLE: map(table(&Table::instance())); break;
+            default: map(exact);
+        }
+    }
+
+    std::vector<Function> functions;
+    Parameters parameters;
 };
 
-#endif
\ No newline at end of file
+#endif
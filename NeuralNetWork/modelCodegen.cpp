@@ -0,0 +1,192 @@
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Perceptrone.h"
+
+using namespace std;
+
+// MLPCodegen <model.mlp> <header.h> <namespace>
+// Writes a standalone header holding the model's weights as constexpr arrays and a
+// predict() with every size and activation fixed at compile time (see
+// generatedModel.hpp), for frozen models built into a binary. mlp_generate_model in
+// CMakeLists.txt runs it as a build step. Weights are written as exact hexadecimal
+// literals, and 16-bit storage is widened to float as the kernels do when loading it.
+class HeaderWriter {
+public:
+    HeaderWriter(const string& filename, bool is_double)
+        : file(fopen(filename.c_str(), "w")), suffix(is_double ? "" : "f") {
+        if (!file) throw runtime_error("Cannot open file for writing");
+    }
+    ~HeaderWriter() { fclose(file); }
+
+    template<typename... Args>
+    void line(const char* format, Args... args) {
+        fprintf(file, format, args...);
+        fputc('\n', file);
+    }
+
+    void value(double v) {
+        if (!isfinite(v)) throw runtime_error("Model holds a value that is not finite");
+        if (v == 0.0 && !signbit(v)) {
+            fputc('0', file);
+        } else {
+            fprintf(file, "%a%s", v, suffix);
+        }
+    }
+
+    // `count` values as a braced list, eight per line.
+    template<typename F>
+    void values(size_t count, F get, const char* indent) {
+        fputc('{', file);
+        for (size_t i = 0; i < count; i++) {
+            if (i % 8 == 0 && count > 8) fprintf(file, "\n%s    ", indent);
+            value(get(i));
+            if (i + 1 < count) fputs(i % 8 == 7 ? "," : ", ", file);
+        }
+        if (count > 8) fprintf(file, "\n%s", indent);
+        fputc('}', file);
+    }
+
+    FILE* raw() { return file; }
+
+private:
+    FILE* file;
+    const char* suffix;
+};
+
+string guard_name(const string& name) {
+    string guard = "MLP_GENERATED_";
+    for (char c : name) guard += char(toupper(static_cast<unsigned char>(c)));
+    return guard + "_H";
+}
+
+bool is_identifier(const string& name) {
+    if (name.empty() || isdigit(static_cast<unsigned char>(name[0]))) return false;
+    for (char c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+    }
+    return true;
+}
+
+template<typename T, typename Storage>
+void generate(const string& from, const string& to, const string& name) {
+    using A = Activator<T>;
+    const Perceptrone<T, Storage> model = Perceptrone<T, Storage>::from_file(from);
+    const vector<size_t>& sizes = model.get_sizes();
+    const auto& activations = model.get_activations();
+    const auto& p = model.get_activation_parameters();
+    const auto biases = model.get_biases();
+    const char* type = is_same<T, double>::value ? "double" : "float";
+    const string guard = guard_name(name);
+
+    HeaderWriter out(to, is_same<T, double>::value);
+    out.line("// Generated by MLPCodegen from %s; do not edit.", from.c_str());
+    out.line("#ifndef %s", guard.c_str());
+    out.line("#define %s", guard.c_str());
+    out.line("");
+    out.line("#include <array>");
+    out.line("#include <cstddef>");
+    out.line("#include \"generatedModel.hpp\"");
+    out.line("");
+    out.line("namespace %s {", name.c_str());
+    out.line("");
+    out.line("using T = %s;", type);
+    out.line("using A = Activator<T>;");
+    out.line("");
+    out.line("constexpr size_t inputs = %zu;", sizes.front());
+    out.line("constexpr size_t outputs = %zu;", sizes.back());
+    fprintf(out.raw(), "constexpr std::array<size_t, %zu> sizes = {", sizes.size());
+    for (size_t i = 0; i < sizes.size(); i++) fprintf(out.raw(), i ? ", %zu" : "%zu", sizes[i]);
+    out.line("};");
+    fprintf(out.raw(), "constexpr A::Parameters parameters = {");
+    out.value(p.alpha);
+    fputs(", ", out.raw());
+    out.value(p.selu_alpha);
+    fputs(", ", out.raw());
+    out.value(p.selu_scale);
+    out.line(", A::EXACT};");
+
+    // w<l> and b<l> feed layer l + 1. Unlike Perceptrone, w<l> is input-major:
+    // w<l>[i][n] is the weight from input i to neuron n, see generatedModel.hpp.
+    for (size_t l = 0; l + 1 < sizes.size(); l++) {
+        const LayerView<Storage> view = model.layer_weights(l);
+        const size_t columns = padded_size<T>(sizes[l + 1]);
+        out.line("");
+        fprintf(out.raw(), "alignas(MLP_ALIGNMENT) inline constexpr T w%zu[%zu][%zu] = {\n",
+                l, sizes[l], columns);
+        for (size_t i = 0; i < sizes[l]; i++) {
+            fputs("    ", out.raw());
+            out.values(columns, [&](size_t n) {
+                return n < sizes[l + 1] ? double(static_cast<T>(view(i, n))) : 0.0;
+            }, "    ");
+            out.line(i + 1 < sizes[l] ? "," : "");
+        }
+        out.line("};");
+        fprintf(out.raw(), "alignas(MLP_ALIGNMENT) inline constexpr T b%zu[%zu] = ", l, sizes[l + 1]);
+        out.values(sizes[l + 1], [&](size_t n) { return double(biases[l + 1][n]); }, "");
+        out.line(";");
+    }
+
+    const size_t last = sizes.size() - 1;
+    out.line("");
+    out.line("// Reads `inputs` values and writes `outputs` values.");
+    out.line("inline void predict(const T* input, T* output) {");
+    for (size_t l = 1; l < last; l++) {
+        out.line("    T x%zu[%zu];", l, sizes[l]);
+    }
+    for (size_t l = 0; l < last; l++) {
+        const string x = l == 0 ? "input" : "x" + to_string(l);
+        const string y = l + 1 == last ? "output" : "x" + to_string(l + 1);
+        string function = A::name(activations[l]);
+        for (char& c : function) c = char(toupper(static_cast<unsigned char>(c)));
+        out.line("    generated_model::dense<T, %zu, %zu, A::%s>(w%zu, b%zu, %s, %s, parameters);",
+                 sizes[l], sizes[l + 1], function.c_str(), l, l, x.c_str(), y.c_str());
+    }
+    out.line("}");
+    out.line("");
+    out.line("inline std::array<T, outputs> predict(const std::array<T, inputs>& input) {");
+    out.line("    std::array<T, outputs> output;");
+    out.line("    predict(input.data(), output.data());");
+    out.line("    return output;");
+    out.line("}");
+    out.line("");
+    out.line("}");
+    out.line("");
+    out.line("#endif");
+
+    printf("%s -> %s (%s::predict):", from.c_str(), to.c_str(), name.c_str());
+    for (size_t size : sizes) printf(" %zu", size);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4 || !is_identifier(argv[3])) {
+        fprintf(stderr, "Использование: %s <модель.mlp> <заголовок.h> <пространство имён>\n", argv[0]);
+        return 2;
+    }
+    try {
+        ifstream file(argv[1], ios::binary);
+        if (!file) throw runtime_error("Cannot open file for reading");
+        const ModelHeader header = read_model_header(file);
+        file.close();
+
+        if (header.compute_type == ValueType::FLOAT64) {
+            generate<double, double>(argv[1], argv[2], argv[3]);
+        } else if (header.storage_type == ValueType::FLOAT16) {
+            generate<float, float16>(argv[1], argv[2], argv[3]);
+        } else if (header.storage_type == ValueType::BFLOAT16) {
+            generate<float, bfloat16>(argv[1], argv[2], argv[3]);
+        } else {
+            generate<float, float>(argv[1], argv[2], argv[3]);
+        }
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        remove(argv[2]);
+        return 1;
+    }
+    return 0;
+}
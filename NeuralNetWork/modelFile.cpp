@@ -0,0 +1,262 @@
+#include "modelFile.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const char model_magic[8] = {'M', 'L', 'P', 'M', 'O', 'D', 'E', 'L'};
+constexpr uint32_t model_version = 1;
+constexpr uint32_t byte_order_mark = 0x01020304;
+
+// Fixed part of the header, before sizes[] and activations[].
+struct FixedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t compute_type;
+    uint32_t storage_type;
+    uint32_t alignment;
+    uint32_t layers;
+    uint64_t file_bytes;
+    double alpha;
+    double selu_alpha;
+    double selu_scale;
+    uint32_t payload_crc;
+    uint32_t header_crc;
+};
+static_assert(sizeof(FixedHeader) == 72, "Model header layout changed");
+
+constexpr size_t header_crc_offset = offsetof(FixedHeader, header_crc);
+
+size_t aligned_bytes(size_t bytes) {
+    return (bytes + MLP_ALIGNMENT - 1) / MLP_ALIGNMENT * MLP_ALIGNMENT;
+}
+
+size_t header_bytes_for(size_t layers) {
+    return aligned_bytes(sizeof(FixedHeader) + layers * sizeof(uint64_t) + (layers - 1) * sizeof(uint32_t));
+}
+
+bool known_value_type(uint32_t type) {
+    return type >= uint32_t(ValueType::FLOAT32) && type <= uint32_t(ValueType::BFLOAT16);
+}
+
+std::array<uint32_t, 256> make_crc_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+std::vector<unsigned char> encode_header(const ModelHeader& header, uint32_t payload_crc) {
+    std::vector<unsigned char> bytes(header.header_bytes(), 0);
+    FixedHeader fixed;
+    std::memcpy(fixed.magic, model_magic, sizeof(model_magic));
+    fixed.version = model_version;
+    fixed.byte_order = byte_order_mark;
+    fixed.compute_type = uint32_t(header.compute_type);
+    fixed.storage_type = uint32_t(header.storage_type);
+    fixed.alignment = uint32_t(MLP_ALIGNMENT);
+    fixed.layers = uint32_t(header.sizes.size());
+    fixed.file_bytes = header.file_bytes();
+    fixed.alpha = header.alpha;
+    fixed.selu_alpha = header.selu_alpha;
+    fixed.selu_scale = header.selu_scale;
+    fixed.payload_crc = payload_crc;
+    fixed.header_crc = 0;
+    std::memcpy(bytes.data(), &fixed, sizeof(fixed));
+
+    unsigned char* at = bytes.data() + sizeof(fixed);
+    for (size_t size : header.sizes) {
+        const uint64_t value = size;
+        std::memcpy(at, &value, sizeof(value));
+        at += sizeof(value);
+    }
+    std::memcpy(at, header.activations.data(), header.activations.size() * sizeof(uint32_t));
+
+    const uint32_t crc = crc32(bytes.data(), bytes.size());
+    std::memcpy(bytes.data() + header_crc_offset, &crc, sizeof(crc));
+    return bytes;
+}
+
+// `bytes` holds at least the fixed header and, if the layer count is sane, the
+// whole header; `file_size` is the length of the file it came from.
+ModelHeader parse_header(const unsigned char* bytes, size_t available, size_t file_size) {
+    FixedHeader fixed;
+    if (available < sizeof(fixed)) {
+        throw std::runtime_error("Unexpected weights file size");
+    }
+    std::memcpy(&fixed, bytes, sizeof(fixed));
+    if (std::memcmp(fixed.magic, model_magic, sizeof(model_magic)) != 0) {
+        throw std::runtime_error("Not a model file");
+    }
+    if (fixed.version != model_version) {
+        throw std::runtime_error("Unsupported model file version " + std::to_string(fixed.version));
+    }
+    if (fixed.byte_order != byte_order_mark) {
+        throw std::runtime_error("Model file was written with a different byte order");
+    }
+    if (fixed.alignment != MLP_ALIGNMENT) {
+        throw std::runtime_error("Model file alignment mismatch");
+    }
+    if (!known_value_type(fixed.compute_type) || !known_value_type(fixed.storage_type)) {
+        throw std::runtime_error("Unknown value type in model file");
+    }
+    if (fixed.layers < 2 || header_bytes_for(fixed.layers) > available) {
+        throw std::runtime_error("Unexpected weights file size");
+    }
+
+    std::vector<unsigned char> copy(bytes, bytes + header_bytes_for(fixed.layers));
+    std::memset(copy.data() + header_crc_offset, 0, sizeof(uint32_t));
+    if (crc32(copy.data(), copy.size()) != fixed.header_crc) {
+        throw std::runtime_error("Model file header checksum mismatch");
+    }
+
+    ModelHeader header;
+    header.version = fixed.version;
+    header.compute_type = ValueType(fixed.compute_type);
+    header.storage_type = ValueType(fixed.storage_type);
+    header.alpha = fixed.alpha;
+    header.selu_alpha = fixed.selu_alpha;
+    header.selu_scale = fixed.selu_scale;
+    header.payload_crc = fixed.payload_crc;
+
+    const unsigned char* at = bytes + sizeof(fixed);
+    header.sizes.resize(fixed.layers);
+    for (auto& layer_size : header.sizes) {
+        uint64_t value;
+        std::memcpy(&value, at, sizeof(value));
+        at += sizeof(value);
+        if (value == 0) throw std::runtime_error("Network structure mismatch");
+        layer_size = size_t(value);
+    }
+    header.activations.resize(fixed.layers - 1);
+    std::memcpy(header.activations.data(), at, header.activations.size() * sizeof(uint32_t));
+
+    if (fixed.file_bytes != header.file_bytes() || file_size != header.file_bytes()) {
+        throw std::runtime_error("Unexpected weights file size");
+    }
+    return header;
+}
+
+}
+
+size_t value_type_bytes(ValueType type) {
+    switch (type) {
+        case ValueType::FLOAT32: return sizeof(float);
+        case ValueType::FLOAT64: return sizeof(double);
+        case ValueType::FLOAT16: return sizeof(float16);
+        case ValueType::BFLOAT16: return sizeof(bfloat16);
+    }
+    throw std::invalid_argument("Unknown value type");
+}
+
+const char* value_type_name(ValueType type) {
+    switch (type) {
+        case ValueType::FLOAT32: return "float32";
+        case ValueType::FLOAT64: return "float64";
+        case ValueType::FLOAT16: return "float16";
+        case ValueType::BFLOAT16: return "bfloat16";
+    }
+    return "unknown";
+}
+
+uint32_t crc32(const void* data, size_t bytes, uint32_t crc) {
+    static const std::array<uint32_t, 256> table = make_crc_table();
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < bytes; i++) {
+        crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+size_t ModelHeader::header_bytes() const {
+    return header_bytes_for(sizes.size());
+}
+
+size_t ModelHeader::stride(size_t layer) const {
+    const size_t block = MLP_ALIGNMENT / value_type_bytes(compute_type);
+    return (sizes[layer] + block - 1) / block * block;
+}
+
+size_t ModelHeader::weight_bytes(size_t layer) const {
+    return aligned_bytes(sizes[layer + 1] * stride(layer) * value_type_bytes(storage_type));
+}
+
+size_t ModelHeader::bias_bytes(size_t layer) const {
+    return aligned_bytes(sizes[layer + 1] * value_type_bytes(storage_type));
+}
+
+size_t ModelHeader::weight_offset(size_t layer) const {
+    size_t offset = header_bytes();
+    for (size_t l = 0; l < layer; l++) {
+        offset += weight_bytes(l) + bias_bytes(l);
+    }
+    return offset;
+}
+
+size_t ModelHeader::file_bytes() const {
+    return weight_offset(sizes.size() - 1);
+}
+
+ModelHeader parse_model_header(const unsigned char* bytes, size_t size) {
+    return parse_header(bytes, size, size);
+}
+
+ModelHeader read_model_header(std::istream& file) {
+    const std::streampos start = file.tellg();
+    file.seekg(0, std::ios::end);
+    const size_t size = size_t(file.tellg() - start);
+    file.seekg(start);
+
+    std::vector<unsigned char> bytes(std::min(size, sizeof(FixedHeader)));
+    file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    if (bytes.size() == sizeof(FixedHeader)) {
+        uint32_t layers;
+        std::memcpy(&layers, bytes.data() + offsetof(FixedHeader, layers), sizeof(layers));
+        if (layers >= 2 && header_bytes_for(layers) <= size) {
+            bytes.resize(header_bytes_for(layers));
+            file.read(reinterpret_cast<char*>(bytes.data()) + sizeof(FixedHeader),
+                      bytes.size() - sizeof(FixedHeader));
+        }
+    }
+    if (!file) throw std::runtime_error("Unexpected weights file size");
+    return parse_header(bytes.data(), bytes.size(), size);
+}
+
+bool is_model_file(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(model_magic)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, model_magic, sizeof(magic)) == 0;
+}
+
+void write_model_header(std::ostream& file, const ModelHeader& header) {
+    const auto bytes = encode_header(header, 0);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+void finish_model_file(std::ostream& file, const ModelHeader& header, uint32_t payload_crc) {
+    const auto bytes = encode_header(header, payload_crc);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    file.seekp(0, std::ios::end);
+    if (!file) throw std::runtime_error("Cannot write weights file");
+}
+
+uint32_t write_model_section(std::ostream& file, const void* data, size_t bytes, uint32_t crc) {
+    static const unsigned char zeros[MLP_ALIGNMENT] = {};
+    const size_t padding = aligned_bytes(bytes) - bytes;
+    file.write(static_cast<const char*>(data), bytes);
+    file.write(reinterpret_cast<const char*>(zeros), padding);
+    crc = crc32(data, bytes, crc);
+    return crc32(zeros, padding, crc);
+}
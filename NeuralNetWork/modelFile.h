@@ -0,0 +1,98 @@
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "alignedAllocator.hpp"
+#include "halfFloat.hpp"
+
+// Self-describing model file (".mlp"), version 1. Everything a loader needs is in the
+// header, so Perceptrone::from_file and MappedPerceptrone need no topology up front.
+//
+//   offset  0  char     magic[8]           "MLPMODEL"
+//           8  uint32   version            1
+//          12  uint32   byte_order         0x01020304 as written by the host
+//          16  uint32   compute_type       ValueType of inputs and arithmetic (T)
+//          20  uint32   storage_type       ValueType of weights and biases (Storage)
+//          24  uint32   alignment          MLP_ALIGNMENT
+//          28  uint32   layers
+//          32  uint64   file_bytes
+//          40  double   alpha, selu_alpha, selu_scale
+//          64  uint32   payload_crc        CRC-32 of every byte after the header
+//          68  uint32   header_crc         CRC-32 of the header with this field zero
+//          72  uint64   sizes[layers]
+//              uint32   activations[layers - 1]
+//              zero padding up to a multiple of `alignment`
+// then for each layer l > 0, every section zero padded to `alignment` bytes:
+//   weights  sizes[l] rows of padded_size<T>(sizes[l - 1]) values, output-major
+//   bias     sizes[l] values
+// The payload is the in-memory layout of Perceptrone, so it can be mapped and run in place.
+
+enum class ValueType : uint32_t {
+    FLOAT32 = 1,
+    FLOAT64,
+    FLOAT16,
+    BFLOAT16
+};
+
+template<typename U> constexpr ValueType value_type_of();
+template<> constexpr ValueType value_type_of<float>() { return ValueType::FLOAT32; }
+template<> constexpr ValueType value_type_of<double>() { return ValueType::FLOAT64; }
+template<> constexpr ValueType value_type_of<float16>() { return ValueType::FLOAT16; }
+template<> constexpr ValueType value_type_of<bfloat16>() { return ValueType::BFLOAT16; }
+
+size_t value_type_bytes(ValueType type);
+const char* value_type_name(ValueType type);
+
+// CRC-32 (IEEE 802.3, as zlib); pass the previous result to continue a running CRC.
+uint32_t crc32(const void* data, size_t bytes, uint32_t crc = 0);
+
+// Parsed header plus the layout it implies.
+struct ModelHeader {
+    uint32_t version = 1;
+    ValueType compute_type = ValueType::FLOAT32;
+    ValueType storage_type = ValueType::FLOAT32;
+    std::vector<size_t> sizes;
+    // Activator<T>::Function values, one per layer after the input.
+    std::vector<uint32_t> activations;
+    double alpha = 0.01;
+    double selu_alpha = 1.67326;
+    double selu_scale = 1.0507;
+    uint32_t payload_crc = 0;
+
+    // Bytes of the header itself, padding included; the payload starts here.
+    size_t header_bytes() const;
+    size_t file_bytes() const;
+    // Values per weight row of layer l + 1, i.e. padded sizes[l] in compute_type.
+    size_t stride(size_t layer) const;
+    // Padded bytes of the weight and bias sections feeding layer l + 1.
+    size_t weight_bytes(size_t layer) const;
+    size_t bias_bytes(size_t layer) const;
+    // Offset of layer l + 1's weights from the start of the file; its bias follows them.
+    size_t weight_offset(size_t layer) const;
+};
+
+// Both check magic, version, byte order, alignment, the header CRC and that the file
+// is file_bytes() long, and throw std::runtime_error otherwise. The payload CRC is
+// returned in the header for the caller to check. parse_model_header reads a file
+// already in memory (`size` bytes at `bytes`); read_model_header leaves the stream at
+// the start of the payload.
+ModelHeader parse_model_header(const unsigned char* bytes, size_t size);
+ModelHeader read_model_header(std::istream& file);
+
+// True when the file starts with the model magic (as opposed to a legacy weights file).
+bool is_model_file(const std::string& filename);
+
+// Writes the header for `header` with zero CRCs; finish_model_file patches them in
+// once the payload is written.
+void write_model_header(std::ostream& file, const ModelHeader& header);
+void finish_model_file(std::ostream& file, const ModelHeader& header, uint32_t payload_crc);
+// Writes `bytes` and zero padding to the next multiple of MLP_ALIGNMENT; returns the
+// running payload CRC.
+uint32_t write_model_section(std::ostream& file, const void* data, size_t bytes, uint32_t crc);
+
+#endif
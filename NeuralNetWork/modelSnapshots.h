@@ -0,0 +1,279 @@
+#ifndef MODEL_SNAPSHOTS_H
+#define MODEL_SNAPSHOTS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Perceptrone.h"
+#include "mappedPerceptrone.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+// Read-copy-update of a model's parameters: inference keeps running on one consistent
+// version while a trainer or a ModelFileWatcher publishes the next. Model is any
+// model with make_workspace() and const predict_into/predict_batch taking a
+// Workspace, such as Perceptrone or MappedPerceptrone.
+//
+// A published version is immutable and shared. Each inference thread reads through
+// its own Reader, which keeps the version it last used; seeing whether there is a
+// newer one is a single atomic load, and only after a publish does the Reader take
+// the mutex, once, to move to it. Replaced versions are kept until no Reader holds
+// them and then freed by a later publish or the destructor, so the inference path
+// never frees a model.
+template<typename Model>
+class ModelSnapshots {
+public:
+    using Snapshot = std::shared_ptr<const Model>;
+
+    // One inference thread's view of the published model. Not thread safe; give each
+    // thread its own, and destroy them before the ModelSnapshots.
+    class Reader {
+    public:
+        explicit Reader(const ModelSnapshots& snapshots) : source(&snapshots) { refresh(); }
+
+        // The newest version. A reference stays valid until the next call on this Reader.
+        const Model& model() {
+            if (source->published.load(std::memory_order_acquire) != seen) refresh();
+            return *current;
+        }
+        // Of the version model() last returned.
+        uint64_t version() const { return seen; }
+
+        template<typename T>
+        void predict_into(const T* input, T* output) {
+            const Model& m = model();
+            m.predict_into(workspace, input, output);
+        }
+        template<typename T>
+        void predict_batch(const T* input, size_t rows, size_t cols, T* output) {
+            const Model& m = model();
+            m.predict_batch(workspace, input, rows, cols, output);
+        }
+
+    private:
+        // The workspace is only remade when the layer sizes change.
+        void refresh() {
+            Snapshot next;
+            {
+                std::lock_guard<std::mutex> lock(source->mutex);
+                next = source->latest;
+                seen = source->published.load(std::memory_order_relaxed);
+            }
+            if (!current || current->get_sizes() != next->get_sizes()) {
+                workspace = next->make_workspace();
+            }
+            current = std::move(next);
+        }
+
+        const ModelSnapshots* source;
+        Snapshot current;
+        uint64_t seen = 0;
+        typename Model::Workspace workspace;
+    };
+
+    explicit ModelSnapshots(Snapshot initial) : latest(std::move(initial)) {
+        if (!latest) throw std::invalid_argument("Model snapshot is empty");
+    }
+    explicit ModelSnapshots(Model initial)
+        : ModelSnapshots(std::make_shared<const Model>(std::move(initial))) {}
+
+    ModelSnapshots(const ModelSnapshots&) = delete;
+    ModelSnapshots& operator=(const ModelSnapshots&) = delete;
+
+    // Makes `next` the version Readers move to and returns its number; the initial
+    // model is version 1. Thread safe.
+    uint64_t publish(Snapshot next) {
+        if (!next) throw std::invalid_argument("Model snapshot is empty");
+        std::vector<Snapshot> unused;
+        uint64_t version;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            retired.push_back(std::exchange(latest, std::move(next)));
+            // Readers only ever take `latest`, so a retired version owned by nothing
+            // but this list cannot be picked up again.
+            auto free = std::partition(retired.begin(), retired.end(),
+                                       [](const Snapshot& s) { return s.use_count() > 1; });
+            unused.assign(std::make_move_iterator(free), std::make_move_iterator(retired.end()));
+            retired.erase(free, retired.end());
+            version = published.load(std::memory_order_relaxed) + 1;
+            published.store(version, std::memory_order_release);
+        }
+        // `unused` is freed here, outside the lock.
+        return version;
+    }
+    uint64_t publish(Model next) { return publish(std::make_shared<const Model>(std::move(next))); }
+
+    // The newest version, for callers without a Reader. Takes the mutex.
+    Snapshot snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return latest;
+    }
+    uint64_t version() const { return published.load(std::memory_order_acquire); }
+    // Replaced versions not yet freed, because a Reader or a snapshot() caller may
+    // still hold them.
+    size_t retained() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return retired.size();
+    }
+
+private:
+    mutable std::mutex mutex;
+    Snapshot latest;
+    std::vector<Snapshot> retired;
+    std::atomic<uint64_t> published{1};
+};
+
+// How ModelFileWatcher reads a model file (see modelFile.h) into each kind of model.
+template<typename Model>
+struct ModelFileLoader;
+
+template<typename T, typename Storage>
+struct ModelFileLoader<Perceptrone<T, Storage>> {
+    static std::shared_ptr<const Perceptrone<T, Storage>> load(const std::string& filename) {
+        return std::make_shared<const Perceptrone<T, Storage>>(Perceptrone<T, Storage>::from_file(filename));
+    }
+};
+
+// Checks the payload checksum, which also reads the new file in before it is served.
+template<typename T, typename Storage>
+struct ModelFileLoader<MappedPerceptrone<T, Storage>> {
+    static std::shared_ptr<const MappedPerceptrone<T, Storage>> load(const std::string& filename) {
+        return std::make_shared<const MappedPerceptrone<T, Storage>>(filename, true);
+    }
+};
+
+// Publishes `filename` into a ModelSnapshots again whenever it changes. The file is
+// polled every `period`; a new device, inode, size, modification or status change
+// time loads it on the watcher's thread. The inode and change time catch a file
+// renamed over the old one within the file system's timestamp granularity with the
+// same size, which the modification time alone misses. Writers should rename a
+// complete file over it, as Perceptrone::save does. A file caught half written fails
+// to load and leaves the current version in place, and is tried again once it
+// changes. `report` is called on the watcher's thread after every attempt, with the
+// published version, or with 0 and the error.
+template<typename Model>
+class ModelFileWatcher {
+public:
+    using Load = std::function<typename ModelSnapshots<Model>::Snapshot(const std::string&)>;
+    using Report = std::function<void(uint64_t version, const char* error)>;
+
+    ModelFileWatcher(ModelSnapshots<Model>& target, std::string filename, std::chrono::milliseconds period,
+                     Report report = {}, Load load = ModelFileLoader<Model>::load)
+        : target(target), filename(std::move(filename)), period(period),
+          report(std::move(report)), load(std::move(load)), stamp(stamp_of(this->filename)) {
+        thread = std::thread([this] { watch(); });
+    }
+    ~ModelFileWatcher() { stop(); }
+
+    ModelFileWatcher(const ModelFileWatcher&) = delete;
+    ModelFileWatcher& operator=(const ModelFileWatcher&) = delete;
+
+    // Waits for a load in progress to finish.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (thread.joinable()) thread.join();
+    }
+
+private:
+    // A missing file has no stamp; the watcher waits for it to appear. Times are in
+    // nanoseconds. Without POSIX stat only the modification time and size are known.
+    struct Stamp {
+        std::uintmax_t device = 0;
+        std::uintmax_t inode = 0;
+        std::uintmax_t size = 0;
+        int64_t modified = 0;
+        int64_t changed = 0;
+        bool exists = false;
+
+        bool operator==(const Stamp& other) const {
+            return exists == other.exists && device == other.device && inode == other.inode &&
+                   size == other.size && modified == other.modified && changed == other.changed;
+        }
+    };
+
+#if defined(__unix__) || defined(__APPLE__)
+    static Stamp stamp_of(const std::string& filename) {
+        struct stat info;
+        Stamp stamp;
+        if (::stat(filename.c_str(), &info) != 0) return stamp;
+#if defined(__APPLE__)
+        const struct timespec& modified = info.st_mtimespec;
+        const struct timespec& changed = info.st_ctimespec;
+#else
+        const struct timespec& modified = info.st_mtim;
+        const struct timespec& changed = info.st_ctim;
+#endif
+        stamp.device = static_cast<std::uintmax_t>(info.st_dev);
+        stamp.inode = static_cast<std::uintmax_t>(info.st_ino);
+        stamp.size = static_cast<std::uintmax_t>(info.st_size);
+        stamp.modified = int64_t(modified.tv_sec) * 1000000000 + modified.tv_nsec;
+        stamp.changed = int64_t(changed.tv_sec) * 1000000000 + changed.tv_nsec;
+        stamp.exists = true;
+        return stamp;
+    }
+#else
+    static Stamp stamp_of(const std::string& filename) {
+        std::error_code error;
+        Stamp stamp;
+        const auto time = std::filesystem::last_write_time(filename, error);
+        if (!error) stamp.size = std::filesystem::file_size(filename, error);
+        if (error) return stamp;
+        stamp.modified = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        stamp.exists = true;
+        return stamp;
+    }
+#endif
+
+    void watch() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, period, [&] { return stopping; })) {
+            const Stamp now = stamp_of(filename);
+            if (!now.exists || now == stamp) continue;
+            stamp = now;
+            lock.unlock();
+            uint64_t version = 0;
+            std::string error;
+            try {
+                version = target.publish(load(filename));
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            if (report) report(version, version ? nullptr : error.c_str());
+            lock.lock();
+        }
+    }
+
+    ModelSnapshots<Model>& target;
+    const std::string filename;
+    const std::chrono::milliseconds period;
+    const Report report;
+    const Load load;
+    // Owned by the watcher's thread once it runs.
+    Stamp stamp;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "neuronPruning.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Hidden neuron `neuron` of layer `layer` (1 .. sizes.size() - 2) over the calibration set.
+struct Candidate {
+    size_t layer;
+    size_t neuron;
+    double mean;
+    double score;
+    bool constant;
+};
+
+// `model` with the `removed` neurons taken out and their means folded into the
+// biases of the layer after them.
+template<typename T, typename Storage>
+Perceptrone<T, Storage> without(const Perceptrone<T, Storage>& model, const std::vector<Candidate>& removed) {
+    const std::vector<size_t>& sizes = model.get_sizes();
+    const auto weights = model.get_weights();
+    auto biases = model.get_biases();
+    std::vector<std::vector<bool>> keep(sizes.size());
+    for (size_t l = 0; l < sizes.size(); l++) {
+        keep[l].assign(sizes[l], true);
+    }
+    for (const Candidate& c : removed) {
+        keep[c.layer][c.neuron] = false;
+        for (size_t k = 0; k < sizes[c.layer + 1]; k++) {
+            biases[c.layer + 1][k] = T(double(biases[c.layer + 1][k]) + c.mean * double(weights[c.layer][c.neuron][k]));
+        }
+    }
+
+    std::vector<size_t> kept_sizes(sizes.size());
+    std::vector<std::vector<T>> kept_biases(sizes.size());
+    for (size_t l = 0; l < sizes.size(); l++) {
+        for (size_t n = 0; n < sizes[l]; n++) {
+            if (keep[l][n]) kept_biases[l].push_back(biases[l][n]);
+        }
+        kept_sizes[l] = kept_biases[l].size();
+    }
+    std::vector<std::vector<std::vector<T>>> kept_weights(weights.size());
+    for (size_t l = 0; l < weights.size(); l++) {
+        for (size_t i = 0; i < sizes[l]; i++) {
+            if (!keep[l][i]) continue;
+            kept_weights[l].emplace_back();
+            for (size_t k = 0; k < sizes[l + 1]; k++) {
+                if (keep[l + 1][k]) kept_weights[l].back().push_back(weights[l][i][k]);
+            }
+        }
+    }
+
+    Perceptrone<T, Storage> pruned(kept_sizes, model.get_activations(), T(0), model.get_activation_parameters());
+    pruned.set_weights(kept_weights);
+    pruned.set_biases(kept_biases);
+    return pruned;
+}
+
+// Largest |difference| between `outputs` and the outputs of `model`; a NaN counts
+// as infinite.
+template<typename T, typename Storage>
+double max_error(const Perceptrone<T, Storage>& model, const T* inputs, size_t rows, const std::vector<T>& outputs) {
+    const std::vector<size_t>& sizes = model.get_sizes();
+    auto ws = model.make_workspace();
+    std::vector<T> y(outputs.size());
+    model.predict_batch(ws, inputs, rows, sizes.front(), y.data());
+    double error = 0.0;
+    for (size_t i = 0; i < y.size(); i++) {
+        const double d = std::abs(double(y[i]) - double(outputs[i]));
+        if (!(d <= error)) error = std::isnan(d) ? std::numeric_limits<double>::infinity() : d;
+    }
+    return error;
+}
+
+}
+
+template<typename T, typename Storage>
+PrunedPerceptrone<T, Storage> prune_neurons(const Perceptrone<T, Storage>& model,
+                                            const T* inputs, size_t rows, double tolerance) {
+    if (rows == 0) {
+        throw std::invalid_argument("Calibration set is empty");
+    }
+    if (!(tolerance >= 0.0)) {
+        throw std::invalid_argument("Tolerance must not be negative");
+    }
+
+    const std::vector<size_t>& sizes = model.get_sizes();
+    const size_t hidden = sizes.size() - 1;
+    std::vector<std::vector<double>> low(hidden), high(hidden), sum(hidden);
+    for (size_t l = 1; l < hidden; l++) {
+        low[l].assign(sizes[l], std::numeric_limits<double>::infinity());
+        high[l].assign(sizes[l], -std::numeric_limits<double>::infinity());
+        sum[l].assign(sizes[l], 0.0);
+    }
+    auto ws = model.make_workspace();
+    std::vector<T> output(sizes.back());
+    for (size_t r = 0; r < rows; r++) {
+        model.predict_into(ws, inputs + r * sizes.front(), output.data());
+        for (size_t l = 1; l < hidden; l++) {
+            const T* a = ws.layer(l);
+            for (size_t n = 0; n < sizes[l]; n++) {
+                low[l][n] = std::min(low[l][n], double(a[n]));
+                high[l][n] = std::max(high[l][n], double(a[n]));
+                sum[l][n] += double(a[n]);
+            }
+        }
+    }
+
+    std::vector<Candidate> candidates;
+    for (size_t l = 1; l < hidden; l++) {
+        const LayerView<Storage> out = model.layer_weights(l);
+        for (size_t n = 0; n < sizes[l]; n++) {
+            const double mean = sum[l][n] / double(rows);
+            const double deviation = std::max(high[l][n] - mean, mean - low[l][n]);
+            double reach = 0.0;
+            for (size_t k = 0; k < out.outputs; k++) {
+                reach += std::abs(double(static_cast<T>(out(n, k))));
+            }
+            const bool constant = low[l][n] == high[l][n];
+            // Non-finite activations leave the neuron in place.
+            if (!std::isfinite(mean) || !std::isfinite(deviation)) continue;
+            candidates.push_back({l, n, mean, constant ? 0.0 : deviation * reach, constant});
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score < b.score; });
+    // Drops the highest-ranked neurons of a layer that would otherwise lose all of them.
+    std::vector<size_t> taken(hidden, 0);
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const Candidate& c) {
+        return ++taken[c.layer] >= sizes[c.layer];
+    }), candidates.end());
+
+    std::vector<T> reference(rows * sizes.back());
+    model.predict_batch(ws, inputs, rows, sizes.front(), reference.data());
+    auto prefix = [&](size_t count) {
+        return std::vector<Candidate>(candidates.begin(), candidates.begin() + count);
+    };
+
+    // Every candidate first, then bisection on the number removed: `lo` is known to
+    // pass and `hi` to fail.
+    PrunedPerceptrone<T, Storage> result{without(model, {}), {}};
+    size_t lo = 0, hi = candidates.size() + 1;
+    for (size_t count = candidates.size(); hi - lo > 1; count = lo + (hi - lo) / 2) {
+        Perceptrone<T, Storage> pruned = without(model, prefix(count));
+        const double error = max_error(pruned, inputs, rows, reference);
+        if (error <= tolerance) {
+            result.model = std::move(pruned);
+            result.report.max_error = error;
+            lo = count;
+        } else {
+            hi = count;
+        }
+    }
+
+    result.report.sizes_before = sizes;
+    result.report.sizes_after = result.model.get_sizes();
+    for (size_t i = 0; i < lo; i++) {
+        (candidates[i].constant ? result.report.constant : result.report.low_contribution)++;
+    }
+    return result;
+}
+
+template PrunedPerceptrone<float, float> prune_neurons(const Perceptrone<float>&, const float*, size_t, double);
+template PrunedPerceptrone<double, double> prune_neurons(const Perceptrone<double>&, const double*, size_t, double);
+template PrunedPerceptrone<float, float16> prune_neurons(const Perceptrone<float, float16>&, const float*, size_t, double);
+template PrunedPerceptrone<float, bfloat16> prune_neurons(const Perceptrone<float, bfloat16>&, const float*, size_t, double);
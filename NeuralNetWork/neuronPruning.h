@@ -0,0 +1,48 @@
+#ifndef NEURON_PRUNING_H
+#define NEURON_PRUNING_H
+
+#include <vector>
+#include "Perceptrone.h"
+
+// Removes whole hidden neurons from a Perceptrone, giving a smaller dense model that
+// runs the regular kernels, unlike prune_by_magnitude (sparsePerceptrone.h), which
+// only zeroes weights.
+//
+// Every hidden neuron is observed over a calibration set of inputs. A neuron that
+// barely moves there, such as a ReLU that never fires, is replaced by its mean
+// output, which is folded into the biases of the next layer. Neurons are ranked by
+// how far they can move the next layer, their largest deviation from the mean times
+// the sum of |outgoing weights|; constant neurons and neurons without outgoing
+// weights rank first. The longest prefix of that ranking whose removal keeps every
+// output within `tolerance` of the original model's over the calibration set is
+// removed, found by bisection. Each hidden layer keeps at least one neuron.
+
+struct NeuronPruningReport {
+    std::vector<size_t> sizes_before;
+    std::vector<size_t> sizes_after;
+    // Removed neurons that were constant over the calibration set, and the others.
+    size_t constant = 0;
+    size_t low_contribution = 0;
+    // Largest |output difference| from the original model over the calibration set.
+    double max_error = 0.0;
+};
+
+template<typename T, typename Storage>
+struct PrunedPerceptrone {
+    Perceptrone<T, Storage> model;
+    NeuronPruningReport report;
+};
+
+// `inputs` holds `rows` calibration inputs of sizes.front() values each. The pruned
+// model keeps the activations and their parameters; throws std::invalid_argument if
+// `rows` is 0 or `tolerance` is negative.
+template<typename T, typename Storage>
+PrunedPerceptrone<T, Storage> prune_neurons(const Perceptrone<T, Storage>& model,
+                                            const T* inputs, size_t rows, double tolerance);
+
+extern template PrunedPerceptrone<float, float> prune_neurons(const Perceptrone<float>&, const float*, size_t, double);
+extern template PrunedPerceptrone<double, double> prune_neurons(const Perceptrone<double>&, const double*, size_t, double);
+extern template PrunedPerceptrone<float, float16> prune_neurons(const Perceptrone<float, float16>&, const float*, size_t, double);
+extern template PrunedPerceptrone<float, bfloat16> prune_neurons(const Perceptrone<float, bfloat16>&, const float*, size_t, double);
+
+#endif
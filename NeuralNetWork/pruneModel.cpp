@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "neuronPruning.h"
+
+using namespace std;
+
+// MLPPrune <model.mlp> <pruned.mlp> [--tolerance E] [--calibration FILE] [--samples N]
+// Removes hidden neurons that barely contribute (see neuronPruning.h) as long as
+// every output stays within E (default 1e-4) of the original's over the calibration
+// set, and writes the smaller model. FILE holds raw calibration inputs, one row of
+// sizes.front() values of the model's compute type after another, as the program
+// feeds them; without it N (default 4096) inputs are drawn uniformly from [-1, 1].
+template<typename T, typename Storage>
+void prune(const char* from, const char* to, double tolerance, const char* calibration, size_t samples) {
+    const Perceptrone<T, Storage> model = Perceptrone<T, Storage>::from_file(from);
+    const size_t inputs = model.get_sizes().front();
+
+    vector<T> rows;
+    if (calibration) {
+        ifstream file(calibration, ios::binary | ios::ate);
+        if (!file) throw runtime_error("Cannot open file for reading");
+        const size_t bytes = size_t(file.tellg());
+        if (bytes == 0 || bytes % (inputs * sizeof(T)) != 0) {
+            throw runtime_error("Calibration file size is not a whole number of input rows");
+        }
+        rows.resize(bytes / sizeof(T));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(rows.data()), streamsize(bytes));
+        if (!file) throw runtime_error("Failed to read calibration file");
+    } else {
+        rows.resize(samples * inputs);
+        RandomStream(0).fill_uniform(rows.data(), rows.size(), T(-1), T(1));
+    }
+
+    const PrunedPerceptrone<T, Storage> pruned = prune_neurons(model, rows.data(), rows.size() / inputs, tolerance);
+    pruned.model.save(to);
+
+    const NeuronPruningReport& report = pruned.report;
+    printf("%s -> %s:", from, to);
+    for (size_t size : report.sizes_before) printf(" %zu", size);
+    printf(" ->");
+    for (size_t size : report.sizes_after) printf(" %zu", size);
+    printf("\nУдалено нейронов: %zu постоянных, %zu с малым вкладом; наибольшая ошибка %g на %zu входах\n",
+           report.constant, report.low_contribution, report.max_error, rows.size() / inputs);
+}
+
+int main(int argc, char** argv) {
+    double tolerance = 1e-4;
+    const char* calibration = nullptr;
+    size_t samples = 4096;
+    bool valid = argc >= 3;
+    for (int i = 3; i < argc && valid; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--tolerance") == 0 && has_value) {
+            tolerance = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--calibration") == 0 && has_value) {
+            calibration = argv[++i];
+        } else if (strcmp(argv[i], "--samples") == 0 && has_value) {
+            samples = strtoul(argv[++i], nullptr, 10);
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || samples == 0) {
+        fprintf(stderr, "Использование: %s <модель.mlp> <результат.mlp> [--tolerance E] "
+                        "[--calibration ФАЙЛ] [--samples N]\n", argv[0]);
+        return 2;
+    }
+    try {
+        ifstream file(argv[1], ios::binary);
+        if (!file) throw runtime_error("Cannot open file for reading");
+        const ModelHeader header = read_model_header(file);
+        file.close();
+
+        if (header.compute_type == ValueType::FLOAT64) {
+            prune<double, double>(argv[1], argv[2], tolerance, calibration, samples);
+        } else if (header.storage_type == ValueType::FLOAT16) {
+            prune<float, float16>(argv[1], argv[2], tolerance, calibration, samples);
+        } else if (header.storage_type == ValueType::BFLOAT16) {
+            prune<float, bfloat16>(argv[1], argv[2], tolerance, calibration, samples);
+        } else {
+            prune<float, float>(argv[1], argv[2], tolerance, calibration, samples);
+        }
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "quantizedPerceptrone.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+int8_t quantize_weight(float w, float inv_scale) {
+    float q = std::nearbyint(w * inv_scale);
+    return static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, q)));
+}
+
+}
+
+QuantizedPerceptrone::Workspace::Workspace(const QuantizedPerceptrone& model) : width(model.width()) {
+    values.assign(padded_size<float>(width), 0.0f);
+    quantized.assign(padded_size<uint8_t>(width), 0);
+}
+
+void QuantizedPerceptrone::check_workspace(const Workspace& ws) const {
+    if (ws.width < width()) {
+        throw std::invalid_argument("Workspace does not match network structure");
+    }
+}
+
+QuantizedPerceptrone::QuantizedPerceptrone(const Perceptrone<float>& model, Granularity granularity)
+    : sizes(model.get_sizes()),
+      activations(model.get_activations()),
+      activationParameters(model.get_activation_parameters()),
+      kernels(&int8_kernels()) {
+    const auto& biases = model.get_biases();
+    layers.resize(sizes.size() - 1);
+
+    for (size_t l = 0; l < layers.size(); l++) {
+        LayerView<float> view = model.layer_weights(l);
+        Layer& layer = layers[l];
+        layer.stride = padded_size<int8_t>(view.inputs);
+        const size_t rows = padded_size<float>(view.outputs);
+        layer.weights.assign(rows * layer.stride, 0);
+        layer.scales.assign(rows, 0.0f);
+        layer.row_sums.assign(rows, 0);
+        layer.bias.assign(rows, 0.0f);
+        std::copy(biases[l + 1].begin(), biases[l + 1].end(), layer.bias.begin());
+
+        float layer_max = 0.0f;
+        for (size_t n = 0; n < view.outputs; n++) {
+            float row_max = 0.0f;
+            for (size_t k = 0; k < view.inputs; k++) {
+                row_max = std::max(row_max, std::abs(view(k, n)));
+            }
+            layer.scales[n] = row_max > 0.0f ? row_max / 127.0f : 1.0f;
+            layer_max = std::max(layer_max, row_max);
+        }
+        if (granularity == PER_LAYER) {
+            std::fill(layer.scales.begin(), layer.scales.begin() + view.outputs,
+                      layer_max > 0.0f ? layer_max / 127.0f : 1.0f);
+        }
+
+        for (size_t n = 0; n < view.outputs; n++) {
+            const float inv_scale = 1.0f / layer.scales[n];
+            int8_t* row = layer.weights.data() + n * layer.stride;
+            int32_t sum = 0;
+            for (size_t k = 0; k < view.inputs; k++) {
+                row[k] = quantize_weight(view(k, n), inv_scale);
+                sum += row[k];
+            }
+            layer.row_sums[n] = sum;
+        }
+    }
+
+    workspace = Workspace(*this);
+}
+
+QuantizedPerceptrone QuantizedPerceptrone::from_weights_file(const std::string& filename,
+        const std::vector<Activator<float>::Function>& activate,
+        Granularity granularity) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open file for reading");
+
+    size_t num_layers = 0;
+    file.read(reinterpret_cast<char*>(&num_layers), sizeof(num_layers));
+    if (!file || num_layers < 2 || num_layers > 1024) {
+        throw std::runtime_error("Invalid weights file");
+    }
+    std::vector<size_t> neurons(num_layers);
+    file.read(reinterpret_cast<char*>(neurons.data()), num_layers * sizeof(size_t));
+    if (!file) throw std::runtime_error("Invalid weights file");
+
+    Perceptrone<float> model(neurons, activate, 0.0f);
+    model.load_weights(filename);
+    return QuantizedPerceptrone(model, granularity);
+}
+
+std::vector<float> QuantizedPerceptrone::predict(const std::vector<float>& input) {
+    if (input.size() != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    std::vector<float> output(sizes.back());
+    predict_into(workspace, input.data(), output.data());
+    return output;
+}
+
+void QuantizedPerceptrone::predict_into(const float* input, float* output) {
+    predict_into(workspace, input, output);
+}
+
+void QuantizedPerceptrone::predict_into(Workspace& ws, const float* input, float* output) const {
+    check_workspace(ws);
+    float* values = ws.values.data();
+    std::copy(input, input + sizes.front(), values);
+    std::fill(values + sizes.front(), values + padded_size<float>(sizes.front()), 0.0f);
+
+    for (size_t l = 0; l < layers.size(); l++) {
+        int32_t zero_point;
+        const float input_scale = kernels->quantize(values, padded_size<float>(sizes[l]),
+                                                    ws.quantized.data(), zero_point);
+        kernels->gemv(layers[l].view(sizes[l + 1]), ws.quantized.data(), input_scale, zero_point,
+                      values, activations[l], activationParameters);
+    }
+
+    std::copy(values, values + sizes.back(), output);
+}
+
+QuantizationReport QuantizedPerceptrone::compare(const Perceptrone<float>& reference,
+                                                 const float* inputs, size_t rows) const {
+    return compare_with_reference(*this, reference, inputs, rows);
+}
+
+size_t QuantizedPerceptrone::parameter_bytes() const {
+    size_t bytes = 0;
+    for (const auto& layer : layers) {
+        bytes += layer.weights.size() * sizeof(int8_t)
+               + layer.scales.size() * sizeof(float)
+               + layer.row_sums.size() * sizeof(int32_t)
+               + layer.bias.size() * sizeof(float);
+    }
+    return bytes;
+}
@@ -0,0 +1,146 @@
+#ifndef QUANTIZED_PERCEPTRONE_H
+#define QUANTIZED_PERCEPTRONE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Perceptrone.h"
+#include "int8Kernels.h"
+
+// Differences between a float model and its int8 version over a set of inputs.
+struct QuantizationReport {
+    size_t samples = 0;
+    double max_abs_error = 0;
+    double mean_abs_error = 0;
+    double max_abs_reference = 0;
+    // Fraction of samples whose largest output is the same neuron in both models.
+    double argmax_agreement = 0;
+    size_t float_bytes = 0;
+    size_t quantized_bytes = 0;
+};
+
+// Runs `rows` row-major inputs through `reference` and through `model`, a reduced
+// version of it with the same sizes (QuantizedPerceptrone, BinaryPerceptrone), and
+// measures the output delta.
+template<typename Model>
+QuantizationReport compare_with_reference(const Model& model, const Perceptrone<float>& reference,
+                                          const float* inputs, size_t rows) {
+    const std::vector<size_t>& sizes = model.get_sizes();
+    if (reference.get_sizes() != sizes) {
+        throw std::invalid_argument("Network structure mismatch");
+    }
+
+    const size_t in = sizes.front(), out = sizes.back();
+    std::vector<float> expected(rows * out), actual(out);
+    auto reference_ws = reference.make_workspace();
+    reference.predict_batch(reference_ws, inputs, rows, in, expected.data());
+
+    auto ws = model.make_workspace();
+    QuantizationReport report;
+    report.samples = rows;
+    size_t agreements = 0;
+    double total_error = 0;
+    for (size_t r = 0; r < rows; r++) {
+        model.predict_into(ws, inputs + r * in, actual.data());
+        const float* ref = expected.data() + r * out;
+        for (size_t n = 0; n < out; n++) {
+            const double error = std::abs(double(actual[n]) - double(ref[n]));
+            report.max_abs_error = std::max(report.max_abs_error, error);
+            report.max_abs_reference = std::max(report.max_abs_reference, std::abs(double(ref[n])));
+            total_error += error;
+        }
+        agreements += std::max_element(ref, ref + out) - ref ==
+                      std::max_element(actual.begin(), actual.end()) - actual.begin();
+    }
+    if (rows > 0) {
+        report.mean_abs_error = total_error / double(rows * out);
+        report.argmax_agreement = double(agreements) / double(rows);
+    }
+
+    for (size_t l = 0; l + 1 < sizes.size(); l++) {
+        report.float_bytes += (sizes[l] * sizes[l + 1] + sizes[l + 1]) * sizeof(float);
+    }
+    report.quantized_bytes = model.parameter_bytes();
+    return report;
+}
+
+// Post-training int8 version of a Perceptrone<float>. Weights are symmetric int8 with
+// one scale per output neuron (PER_CHANNEL) or per layer (PER_LAYER). Each layer's
+// input is quantized on the fly to 7-bit unsigned values with its own scale and zero
+// point, multiplied in int32 by the int8 kernels, then rescaled to float for the bias
+// and activation.
+class QuantizedPerceptrone {
+public:
+    enum Granularity {
+        PER_LAYER,
+        PER_CHANNEL
+    };
+
+    class Workspace {
+    public:
+        Workspace() = default;
+        explicit Workspace(const QuantizedPerceptrone& model);
+
+    private:
+        friend class QuantizedPerceptrone;
+
+        // Widest layer the buffers hold.
+        size_t width = 0;
+        AlignedVector<float> values;
+        AlignedVector<uint8_t> quantized;
+    };
+
+    explicit QuantizedPerceptrone(const Perceptrone<float>& model,
+                                  Granularity granularity = PER_CHANNEL);
+
+    // Quantizes a weights file written by Perceptrone<float>::save_weights.
+    static QuantizedPerceptrone from_weights_file(const std::string& filename,
+        const std::vector<Activator<float>::Function>& activate,
+        Granularity granularity = PER_CHANNEL);
+
+    Workspace make_workspace() const { return Workspace(*this); }
+
+    std::vector<float> predict(const std::vector<float>& input);
+    void predict_into(const float* input, float* output);
+    // Throws std::invalid_argument if ws is too narrow for this model.
+    void predict_into(Workspace& ws, const float* input, float* output) const;
+
+    // Runs `rows` row-major inputs through both models and measures the output delta.
+    QuantizationReport compare(const Perceptrone<float>& reference,
+                               const float* inputs, size_t rows) const;
+
+    const std::vector<size_t>& get_sizes() const { return sizes; }
+    size_t parameter_bytes() const;
+    // Lowered to what the CPU supports, as for Perceptrone::set_simd_isa.
+    void set_simd_isa(SimdIsa isa) { kernels = &int8_kernels(isa); }
+    const char* kernel_name() const { return kernels->name; }
+
+private:
+    struct Layer {
+        // padded_size<float>(outputs) rows of `stride` bytes, zero padded.
+        AlignedVector<int8_t> weights;
+        size_t stride;
+        // Per-row arrays, zero padded like the rows.
+        std::vector<float> scales;
+        std::vector<int32_t> row_sums;
+        std::vector<float> bias;
+
+        Int8Layer view(size_t outputs) const {
+            return {weights.data(), stride, outputs, scales.data(), row_sums.data(), bias.data()};
+        }
+    };
+
+    void check_workspace(const Workspace& ws) const;
+    size_t width() const { return *std::max_element(sizes.begin(), sizes.end()); }
+
+    std::vector<size_t> sizes;
+    std::vector<Layer> layers;
+    std::vector<Activator<float>::Function> activations;
+    Activator<float>::Parameters activationParameters;
+    const Int8Kernels* kernels;
+    Workspace workspace;
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include "randomStream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+
+using namespace random_detail;
+
+namespace {
+
+void philox_scalar(uint64_t key, uint64_t id, uint64_t first, size_t blocks, uint32_t* out) {
+    for (size_t b = 0; b < blocks; b++) {
+        const uint64_t n = first + b;
+        uint32_t c0 = uint32_t(n), c1 = uint32_t(n >> 32), c2 = uint32_t(id), c3 = uint32_t(id >> 32);
+        uint32_t k0 = uint32_t(key), k1 = uint32_t(key >> 32);
+        for (int r = 0; r < philox_rounds; r++) {
+            const uint64_t p0 = uint64_t(philox_m0) * c0;
+            const uint64_t p1 = uint64_t(philox_m1) * c2;
+            c0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+            c1 = uint32_t(p1);
+            c2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+            c3 = uint32_t(p0);
+            k0 += philox_w0;
+            k1 += philox_w1;
+        }
+        out[4 * b] = c0;
+        out[4 * b + 1] = c1;
+        out[4 * b + 2] = c2;
+        out[4 * b + 3] = c3;
+    }
+}
+
+constexpr RandomKernels scalar_table = {SimdIsa::SCALAR, philox_scalar};
+
+// splitmix64 finalizer, to spread substream ids over the 64-bit id space.
+uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+float unit_float(uint32_t w) { return float(w >> 8) * 0x1p-24f; }
+double unit_double(uint32_t a, uint32_t b) {
+    return double((uint64_t(a >> 5) << 26) | (b >> 6)) * 0x1p-53;
+}
+
+// Words of random bits per uniform value and per Box-Muller pair.
+template<typename T> struct Draw;
+template<> struct Draw<float> {
+    static constexpr size_t uniform_words = 1;
+    static constexpr size_t pair_words = 2;
+    static float unit(const uint32_t* w) { return unit_float(w[0]); }
+    // In (0, 1], so the logarithm is finite.
+    static float open_unit(const uint32_t* w) { return float((w[0] >> 8) + 1) * 0x1p-24f; }
+};
+template<> struct Draw<double> {
+    static constexpr size_t uniform_words = 2;
+    static constexpr size_t pair_words = 4;
+    static double unit(const uint32_t* w) { return unit_double(w[0], w[1]); }
+    static double open_unit(const uint32_t* w) { return unit_double(w[0], w[1]) + 0x1p-53; }
+};
+
+// Words generated per step of a bulk fill: 64 blocks, on the stack.
+constexpr size_t chunk_words = 256;
+
+struct GlobalRandom {
+    std::mutex mutex;
+    bool seeded = false;
+    uint64_t seed = 0;
+    uint64_t next = 0;
+
+    void ensure_seeded() {
+        if (seeded) return;
+        if (const char* env = std::getenv("MLP_SEED")) {
+            seed = std::strtoull(env, nullptr, 0);
+        } else {
+            std::random_device rd;
+            seed = (uint64_t(rd()) << 32) ^ rd();
+        }
+        seeded = true;
+    }
+};
+
+GlobalRandom& global_random() {
+    static GlobalRandom state;
+    return state;
+}
+
+}
+
+const RandomKernels& random_kernels(SimdIsa isa) {
+    static const SimdIsa supported = detect_simd_isa();
+    if (isa > supported) isa = supported;
+
+    const RandomKernels* table = nullptr;
+    switch (isa) {
+        case SimdIsa::AVX512:
+            table = avx512_kernels();
+            if (table) break;
+            // fall through
+        case SimdIsa::AVX2:
+            table = avx2_kernels();
+            if (table) break;
+            // fall through
+        default:
+            table = &scalar_table;
+    }
+    return *table;
+}
+
+const RandomKernels& random_kernels() {
+    static const RandomKernels& table = random_kernels(selected_simd_isa());
+    return table;
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t stream) : key(seed), id(stream) {}
+
+RandomStream RandomStream::substream(uint64_t sub) const {
+    return RandomStream(key, mix64(id + 0x9E3779B97F4A7C15ull * (sub + 1)));
+}
+
+void RandomStream::refill() {
+    random_kernels().philox(key, id, counter++, 1, buffer);
+    buffered = 4;
+}
+
+uint32_t RandomStream::next_u32() {
+    if (buffered == 0) refill();
+    return buffer[4 - buffered--];
+}
+
+uint32_t RandomStream::below(uint32_t n) {
+    // Lemire's multiply-shift with rejection of the biased low range.
+    uint64_t m = uint64_t(next_u32()) * n;
+    if (uint32_t(m) < n) {
+        const uint32_t threshold = uint32_t(-n) % n;
+        while (uint32_t(m) < threshold) {
+            m = uint64_t(next_u32()) * n;
+        }
+    }
+    return uint32_t(m >> 32);
+}
+
+template<typename T>
+T RandomStream::uniform(T lo, T hi) {
+    uint32_t words[Draw<T>::uniform_words];
+    for (auto& w : words) w = next_u32();
+    return lo + (hi - lo) * Draw<T>::unit(words);
+}
+
+void RandomStream::fill_u32(uint32_t* out, size_t n) {
+    buffered = 0;
+    const size_t blocks = n / 4;
+    random_kernels().philox(key, id, counter, blocks, out);
+    counter += blocks;
+    if (n % 4) {
+        uint32_t tail[4];
+        random_kernels().philox(key, id, counter++, 1, tail);
+        for (size_t i = 0; i < n % 4; i++) out[blocks * 4 + i] = tail[i];
+    }
+}
+
+template<typename T>
+void RandomStream::fill_uniform(T* out, size_t n, T lo, T hi) {
+    constexpr size_t words_per = Draw<T>::uniform_words;
+    uint32_t words[chunk_words];
+    const T range = hi - lo;
+    while (n > 0) {
+        const size_t count = std::min(n, chunk_words / words_per);
+        fill_u32(words, count * words_per);
+        for (size_t i = 0; i < count; i++) {
+            out[i] = lo + range * Draw<T>::unit(words + i * words_per);
+        }
+        out += count;
+        n -= count;
+    }
+}
+
+template<typename T>
+void RandomStream::fill_normal(T* out, size_t n, T mean, T stddev) {
+    constexpr size_t words_per = Draw<T>::pair_words;
+    constexpr T two_pi = T(6.283185307179586476925);
+    uint32_t words[chunk_words];
+    while (n > 0) {
+        const size_t count = std::min(n, 2 * (chunk_words / words_per));
+        const size_t pairs = (count + 1) / 2;
+        fill_u32(words, pairs * words_per);
+        for (size_t p = 0; p < pairs; p++) {
+            const uint32_t* w = words + p * words_per;
+            const T r = stddev * std::sqrt(T(-2) * std::log(Draw<T>::open_unit(w)));
+            const T theta = two_pi * Draw<T>::unit(w + words_per / 2);
+            out[2 * p] = mean + r * std::cos(theta);
+            if (2 * p + 1 < count) out[2 * p + 1] = mean + r * std::sin(theta);
+        }
+        out += count;
+        n -= count;
+    }
+}
+
+uint64_t random_seed() {
+    GlobalRandom& state = global_random();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.ensure_seeded();
+    return state.seed;
+}
+
+void set_random_seed(uint64_t seed) {
+    GlobalRandom& state = global_random();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.seed = seed;
+    state.seeded = true;
+    state.next = 0;
+}
+
+RandomStream next_random_stream() {
+    GlobalRandom& state = global_random();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.ensure_seeded();
+    return RandomStream(state.seed, state.next++);
+}
+
+template float RandomStream::uniform<float>(float, float);
+template double RandomStream::uniform<double>(double, double);
+template void RandomStream::fill_uniform<float>(float*, size_t, float, float);
+template void RandomStream::fill_uniform<double>(double*, size_t, double, double);
+template void RandomStream::fill_normal<float>(float*, size_t, float, float);
+template void RandomStream::fill_normal<double>(double*, size_t, double, double);
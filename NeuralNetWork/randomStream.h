@@ -0,0 +1,87 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include "simdKernels.h"
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as
+// easy as 1, 2, 3"). Block n of a stream is a pure function of (seed, stream id, n),
+// so any block can be computed without the ones before it: streams never share
+// state, bulk fills run many blocks per SIMD register, and a result depends only on
+// the seed and which stream produced it, never on thread count or ISA.
+class RandomStream {
+public:
+    explicit RandomStream(uint64_t seed = 0, uint64_t stream = 0);
+
+    // Independent stream `id` below this one, e.g. per layer, thread or individual.
+    // Its output does not depend on how much of this stream has been used.
+    RandomStream substream(uint64_t id) const;
+
+    uint64_t seed() const { return key; }
+    uint64_t stream() const { return id; }
+
+    uint32_t next_u32();
+    // Uniform in [0, n), n > 0.
+    uint32_t below(uint32_t n);
+    // Uniform in [lo, hi) for float or double.
+    template<typename T>
+    T uniform(T lo, T hi);
+
+    // Bulk draws. Each fill starts at the next whole block, skipping words left over
+    // by next_u32, and consumes whole blocks, so a stream filled in one call or in
+    // several calls of block-multiple sizes gives the same values.
+    void fill_u32(uint32_t* out, size_t n);
+    // T is float (24 random bits per value) or double (53 bits, two words each).
+    template<typename T>
+    void fill_uniform(T* out, size_t n, T lo, T hi);
+    // Box-Muller, one pair of values per two (float) or four (double) words.
+    template<typename T>
+    void fill_normal(T* out, size_t n, T mean, T stddev);
+
+private:
+    void refill();
+
+    uint64_t key;
+    uint64_t id;
+    // Next block to generate.
+    uint64_t counter = 0;
+    uint32_t buffer[4] = {};
+    unsigned buffered = 0;
+};
+
+// Seed of every stream the library creates itself, e.g. when a Perceptrone is
+// initialized. Taken from the MLP_SEED environment variable if set, otherwise from
+// std::random_device, the first time it is needed.
+uint64_t random_seed();
+// Fixes the seed and restarts next_random_stream at stream 0, so a program that
+// calls this first creates bit-identical models and populations on every run.
+void set_random_seed(uint64_t seed);
+// Stream random_seed() / k for k = 0, 1, 2, ... in call order. Thread safe.
+RandomStream next_random_stream();
+
+// Philox block generators for one instruction set. All produce the same bits.
+struct RandomKernels {
+    SimdIsa isa;
+    // Writes blocks first .. first + blocks - 1 of stream (key, id) to out, four words
+    // per block in counter order.
+    void (*philox)(uint64_t key, uint64_t id, uint64_t first, size_t blocks, uint32_t* out);
+};
+
+// Kernels for selected_simd_isa(), so MLP_ISA caps them as it does the forward kernels.
+const RandomKernels& random_kernels();
+const RandomKernels& random_kernels(SimdIsa isa);
+
+namespace random_detail {
+    // Defined by the per-ISA translation units; nullptr when the ISA is not built.
+    const RandomKernels* avx2_kernels();
+    const RandomKernels* avx512_kernels();
+
+    constexpr uint32_t philox_m0 = 0xD2511F53u;
+    constexpr uint32_t philox_m1 = 0xCD9E8D57u;
+    constexpr uint32_t philox_w0 = 0x9E3779B9u;
+    constexpr uint32_t philox_w1 = 0xBB67AE85u;
+    constexpr int philox_rounds = 10;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "randomStream.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("avx2")
+#include "randomStreamImpl.hpp"
+
+namespace {
+
+struct Avx2U32 {
+    using reg = __m256i;
+    static constexpr size_t lanes = 8;
+
+    static reg set1(uint32_t v) { return _mm256_set1_epi32(int(v)); }
+    static reg iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+    static reg xor3(reg a, reg b, reg c) { return _mm256_xor_si256(_mm256_xor_si256(a, b), c); }
+    static void mul(reg a, uint32_t m, reg& hi, reg& lo) {
+        const reg mm = set1(m);
+        // vpmuludq multiplies the even lanes; the odd ones are shifted down for a second pass.
+        const reg even = _mm256_mul_epu32(a, mm);
+        const reg odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), mm);
+        lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    }
+    static void store_blocks(uint32_t* out, reg c0, reg c1, reg c2, reg c3) {
+        // 4 x 4 transposes within each 128-bit half: u[j] holds blocks j and j + 4.
+        const reg t0 = _mm256_unpacklo_epi32(c0, c1), t1 = _mm256_unpacklo_epi32(c2, c3);
+        const reg t2 = _mm256_unpackhi_epi32(c0, c1), t3 = _mm256_unpackhi_epi32(c2, c3);
+        const reg u0 = _mm256_unpacklo_epi64(t0, t1), u1 = _mm256_unpackhi_epi64(t0, t1);
+        const reg u2 = _mm256_unpacklo_epi64(t2, t3), u3 = _mm256_unpackhi_epi64(t2, t3);
+        __m256i* o = reinterpret_cast<__m256i*>(out);
+        _mm256_storeu_si256(o, _mm256_permute2x128_si256(u0, u1, 0x20));
+        _mm256_storeu_si256(o + 1, _mm256_permute2x128_si256(u2, u3, 0x20));
+        _mm256_storeu_si256(o + 2, _mm256_permute2x128_si256(u0, u1, 0x31));
+        _mm256_storeu_si256(o + 3, _mm256_permute2x128_si256(u2, u3, 0x31));
+    }
+};
+
+constexpr RandomKernels avx2_table = PhiloxImpl<Avx2U32>::table(SimdIsa::AVX2);
+
+}
+
+const RandomKernels* random_detail::avx2_kernels() { return &avx2_table; }
+
+#else
+
+const RandomKernels* random_detail::avx2_kernels() { return nullptr; }
+
+#endif
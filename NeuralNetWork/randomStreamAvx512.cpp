@@ -0,0 +1,51 @@
+#include "randomStream.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("avx512f,avx2")
+#include "randomStreamImpl.hpp"
+
+namespace {
+
+struct Avx512U32 {
+    using reg = __m512i;
+    static constexpr size_t lanes = 16;
+
+    static reg set1(uint32_t v) { return _mm512_set1_epi32(int(v)); }
+    static reg iota() { return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+    static reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+    static reg xor3(reg a, reg b, reg c) { return _mm512_ternarylogic_epi32(a, b, c, 0x96); }
+    static void mul(reg a, uint32_t m, reg& hi, reg& lo) {
+        const reg mm = set1(m);
+        const reg even = _mm512_mul_epu32(a, mm);
+        const reg odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), mm);
+        lo = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+        hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+    }
+    static void store_blocks(uint32_t* out, reg c0, reg c1, reg c2, reg c3) {
+        // 4 x 4 transposes within each 128-bit lane: u[j] holds blocks j, j + 4, j + 8, j + 12.
+        const reg t0 = _mm512_unpacklo_epi32(c0, c1), t1 = _mm512_unpacklo_epi32(c2, c3);
+        const reg t2 = _mm512_unpackhi_epi32(c0, c1), t3 = _mm512_unpackhi_epi32(c2, c3);
+        const reg u0 = _mm512_unpacklo_epi64(t0, t1), u1 = _mm512_unpackhi_epi64(t0, t1);
+        const reg u2 = _mm512_unpacklo_epi64(t2, t3), u3 = _mm512_unpackhi_epi64(t2, t3);
+        // Gather 128-bit lane k of u0..u3 into blocks 4k .. 4k + 3.
+        const reg lo01 = _mm512_shuffle_i32x4(u0, u1, 0x44), hi01 = _mm512_shuffle_i32x4(u0, u1, 0xEE);
+        const reg lo23 = _mm512_shuffle_i32x4(u2, u3, 0x44), hi23 = _mm512_shuffle_i32x4(u2, u3, 0xEE);
+        _mm512_storeu_si512(out, _mm512_shuffle_i32x4(lo01, lo23, 0x88));
+        _mm512_storeu_si512(out + 16, _mm512_shuffle_i32x4(lo01, lo23, 0xDD));
+        _mm512_storeu_si512(out + 32, _mm512_shuffle_i32x4(hi01, hi23, 0x88));
+        _mm512_storeu_si512(out + 48, _mm512_shuffle_i32x4(hi01, hi23, 0xDD));
+    }
+};
+
+constexpr RandomKernels avx512_table = PhiloxImpl<Avx512U32>::table(SimdIsa::AVX512);
+
+}
+
+const RandomKernels* random_detail::avx512_kernels() { return &avx512_table; }
+
+#else
+
+const RandomKernels* random_detail::avx512_kernels() { return nullptr; }
+
+#endif
@@ -0,0 +1,61 @@
+// Shared body of the Philox kernels. Each randomStream*.cpp includes this after
+// selecting its target ISA and instantiates PhiloxImpl with its register type, so
+// everything here must stay in the anonymous namespace.
+#ifndef RANDOM_STREAM_IMPL_HPP
+#define RANDOM_STREAM_IMPL_HPP
+
+#include <climits>
+#include "randomStream.h"
+
+namespace {
+
+// V provides: reg, lanes, set1(v), iota() = {0, 1, 2, ...}, add(a, b), xor3(a, b, c)
+// = a ^ b ^ c, mul(a, m, hi, lo), which splits the 64-bit product of every 32-bit
+// lane of a with m into its high and low halves, and store_blocks(out, c0, c1, c2, c3),
+// which writes lane i of the four registers to out[4 * i .. 4 * i + 3].
+template<typename V>
+struct PhiloxImpl {
+    using R = typename V::reg;
+    static constexpr size_t lanes = V::lanes;
+
+    // V::lanes blocks at once, one per lane, with counter word j of every block in
+    // register cj.
+    static void philox(uint64_t key, uint64_t id, uint64_t first, size_t blocks, uint32_t* out) {
+        using namespace random_detail;
+        const R iota = V::iota();
+        const R id0 = V::set1(uint32_t(id)), id1 = V::set1(uint32_t(id >> 32));
+        size_t b = 0;
+        for (; b + lanes <= blocks; b += lanes) {
+            const uint64_t n = first + b;
+            if (uint32_t(n) > UINT32_MAX - (lanes - 1)) {
+                // The low counter word wraps inside this group; rare enough for scalar.
+                random_kernels(SimdIsa::SCALAR).philox(key, id, n, lanes, out + 4 * b);
+                continue;
+            }
+            R c0 = V::add(V::set1(uint32_t(n)), iota), c1 = V::set1(uint32_t(n >> 32));
+            R c2 = id0, c3 = id1;
+            uint32_t k0 = uint32_t(key), k1 = uint32_t(key >> 32);
+            for (int r = 0; r < philox_rounds; r++) {
+                R hi0, lo0, hi1, lo1;
+                V::mul(c0, philox_m0, hi0, lo0);
+                V::mul(c2, philox_m1, hi1, lo1);
+                c0 = V::xor3(hi1, c1, V::set1(k0));
+                c1 = lo1;
+                c2 = V::xor3(hi0, c3, V::set1(k1));
+                c3 = lo0;
+                k0 += philox_w0;
+                k1 += philox_w1;
+            }
+            V::store_blocks(out + 4 * b, c0, c1, c2, c3);
+        }
+        if (b < blocks) {
+            random_kernels(SimdIsa::SCALAR).philox(key, id, first + b, blocks - b, out + 4 * b);
+        }
+    }
+
+    static constexpr RandomKernels table(SimdIsa isa) { return {isa, philox}; }
+};
+
+}
+
+#endif
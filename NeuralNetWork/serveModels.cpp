@@ -0,0 +1,97 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "inferenceServer.h"
+
+using namespace std;
+
+// MLPServer <socket> <model.mlp>... [--max-batch N] [--max-latency-us U] [--report S]
+//           [--reload-ms R]
+// Serves the model files over a Unix domain socket, model i being the i-th file, and
+// prints latency and throughput every S seconds (default 5) and on SIGINT or SIGTERM.
+// With R, checks the files every R milliseconds and serves a rewritten one without
+// restarting, e.g. while a trainer saves its best model over it.
+void print_stats(const InferenceServer::Stats& stats) {
+    const LatencySummary& l = stats.latency;
+    printf("%zu запросов за %.1f с: %.0f запросов/с, p50 %.0f мкс, p99 %.0f мкс, пакет %.1f\n",
+           l.requests, l.seconds, l.requests_per_second(), l.p50_us, l.p99_us, stats.mean_batch());
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    InferenceServer::Options options;
+    double report_seconds = 5.0;
+    vector<string> models;
+    for (int i = 2; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--max-batch") == 0 && has_value) {
+            options.max_batch = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--max-latency-us") == 0 && has_value) {
+            options.max_latency = chrono::microseconds(strtol(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--report") == 0 && has_value) {
+            report_seconds = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--reload-ms") == 0 && has_value) {
+            options.reload_interval = chrono::milliseconds(strtol(argv[++i], nullptr, 10));
+        } else {
+            models.push_back(argv[i]);
+        }
+    }
+    if (argc < 3 || models.empty() || report_seconds <= 0.0) {
+        fprintf(stderr, "Использование: %s <сокет> <модель.mlp>... [--max-batch N] "
+                        "[--max-latency-us U] [--report S] [--reload-ms R]\n", argv[0]);
+        return 2;
+    }
+
+    // Blocked before any thread starts, so every thread inherits the mask and the
+    // signals are only ever taken by the sigtimedwait below.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    options.on_reload = [&models](size_t model, uint64_t version, const char* error) {
+        if (error) {
+            printf("Модель %zu: %s не загружена, остаётся прежняя версия: %s\n", model, models[model].c_str(), error);
+        } else {
+            printf("Модель %zu: %s загружена, версия %llu\n", model, models[model].c_str(),
+                   static_cast<unsigned long long>(version));
+        }
+        fflush(stdout);
+    };
+
+    try {
+        InferenceServer server(argv[1], models, options);
+        for (size_t i = 0; i < server.model_count(); i++) {
+            const auto model = server.model(i);
+            const auto& sizes = model->get_sizes();
+            printf("Модель %zu: %s,", i, models[i].c_str());
+            for (size_t size : sizes) printf(" %zu", size);
+            printf("\n");
+        }
+        printf("Сокет %s, пакет до %zu, ожидание до %lld мкс\n", argv[1], options.max_batch,
+               static_cast<long long>(options.max_latency.count()));
+        fflush(stdout);
+
+        const timespec period = {time_t(report_seconds),
+                                 long((report_seconds - double(time_t(report_seconds))) * 1e9)};
+        for (;;) {
+            const int signal = sigtimedwait(&signals, nullptr, &period);
+            if (signal == SIGINT || signal == SIGTERM) break;
+            const InferenceServer::Stats stats = server.take_stats();
+            if (stats.latency.requests > 0) print_stats(stats);
+        }
+        server.stop();
+        const InferenceServer::Stats stats = server.take_stats();
+        if (stats.latency.requests > 0) print_stats(stats);
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "simdKernels.h"
+#include <cstdlib>
+#include <cstring>
+#include "simdKernelsImpl.hpp"
+
+namespace {
+
+template<typename T>
+struct ScalarOps {
+    using scalar = T;
+    using reg = T;
+    static constexpr size_t width = 1;
+
+    static reg zero() { return T(0); }
+    static reg set1(T v) { return v; }
+    template<typename U>
+    static reg load(const U* p) { return static_cast<T>(*p); }
+    static reg gather(const T* base, const uint32_t* index) { return base[*index]; }
+    static void store(T* p, reg v) { *p = v; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+    static T hsum(reg v) { return v; }
+};
+
+constexpr SimdKernels<float> scalar_f32 = KernelImpl<ScalarOps<float>>::table(SimdIsa::SCALAR);
+constexpr SimdKernels<double> scalar_f64 = KernelImpl<ScalarOps<double>>::table(SimdIsa::SCALAR);
+constexpr SimdKernels<float, float16> scalar_f16 =
+    KernelImpl<ScalarOps<float>, float16>::table(SimdIsa::SCALAR);
+constexpr SimdKernels<float, bfloat16> scalar_bf16 =
+    KernelImpl<ScalarOps<float>, bfloat16>::table(SimdIsa::SCALAR);
+
+template<typename T, typename W> const SimdKernels<T, W>& scalar_kernels();
+template<> const SimdKernels<float>& scalar_kernels<float, float>() { return scalar_f32; }
+template<> const SimdKernels<double>& scalar_kernels<double, double>() { return scalar_f64; }
+template<> const SimdKernels<float, float16>& scalar_kernels<float, float16>() { return scalar_f16; }
+template<> const SimdKernels<float, bfloat16>& scalar_kernels<float, bfloat16>() { return scalar_bf16; }
+
+}
+
+SimdIsa detect_simd_isa() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdIsa::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdIsa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdIsa::SSE2;
+#endif
+    return SimdIsa::SCALAR;
+}
+
+SimdIsa selected_simd_isa() {
+    SimdIsa isa = detect_simd_isa();
+    const char* env = std::getenv("MLP_ISA");
+    if (!env) return isa;
+
+    SimdIsa cap = SimdIsa::AVX512;
+    if (std::strcmp(env, "scalar") == 0) cap = SimdIsa::SCALAR;
+    else if (std::strcmp(env, "sse2") == 0) cap = SimdIsa::SSE2;
+    else if (std::strcmp(env, "avx2") == 0) cap = SimdIsa::AVX2;
+    return isa < cap ? isa : cap;
+}
+
+const char* simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::SSE2: return "sse2";
+        case SimdIsa::AVX2: return "avx2";
+        case SimdIsa::AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+template<typename T, typename W>
+const SimdKernels<T, W>& simd_kernels(SimdIsa isa) {
+    static const SimdIsa supported = detect_simd_isa();
+    if (isa > supported) isa = supported;
+
+    const SimdKernels<T, W>* table = nullptr;
+    switch (isa) {
+        case SimdIsa::AVX512:
+            table = simd_detail::avx512_kernels<T, W>();
+            if (table) break;
+            // fall through
+        case SimdIsa::AVX2:
+            table = simd_detail::avx2_kernels<T, W>();
+            if (table) break;
+            // fall through
+        case SimdIsa::SSE2:
+            table = simd_detail::sse2_kernels<T, W>();
+            if (table) break;
+            // fall through
+        default:
+            table = &scalar_kernels<T, W>();
+    }
+    return *table;
+}
+
+template<typename T, typename W>
+const SimdKernels<T, W>& simd_kernels() {
+    static const SimdKernels<T, W>& table = simd_kernels<T, W>(selected_simd_isa());
+    return table;
+}
+
+template const SimdKernels<float>& simd_kernels<float>();
+template const SimdKernels<double>& simd_kernels<double>();
+template const SimdKernels<float, float16>& simd_kernels<float, float16>();
+template const SimdKernels<float, bfloat16>& simd_kernels<float, bfloat16>();
+template const SimdKernels<float>& simd_kernels<float>(SimdIsa);
+template const SimdKernels<double>& simd_kernels<double>(SimdIsa);
+template const SimdKernels<float, float16>& simd_kernels<float, float16>(SimdIsa);
+template const SimdKernels<float, bfloat16>& simd_kernels<float, bfloat16>(SimdIsa);
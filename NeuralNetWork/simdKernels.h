@@ -0,0 +1,105 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "alignedAllocator.hpp"
+#include "halfFloat.hpp"
+#include "mlpActivators.hpp"
+
+enum class SimdIsa {
+    SCALAR = 0,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// Forward-pass kernels for one instruction set. Weight rows and input vectors are
+// `stride` values long, zero padded, with stride a multiple of MLP_ALIGNMENT / sizeof(T).
+//
+// Every kernel accumulates a dot product in MLP_ALIGNMENT / sizeof(T) lanes and folds
+// the lanes in the same order, so SCALAR and SSE2 agree bit for bit, as do AVX2 and
+// AVX512; the two groups differ only by FMA rounding.
+//
+// The activation is applied in the kernel epilogue, to each tile of outputs while
+// it is still in L1, instead of in a separate pass over the layer.
+//
+// Weights and biases are stored as W and widened to T as they are loaded; W is T,
+// or float16 / bfloat16 with T = float. Widening is exact, so the guarantees above
+// hold for every W.
+template<typename T, typename W = T>
+struct SimdKernels {
+    using Function = typename Activator<T>::Function;
+    using Parameters = typename Activator<T>::Parameters;
+
+    SimdIsa isa;
+
+    // y[n] = f(b[n] + W[n] . x) for n < outputs.
+    void (*gemv)(const W* w, size_t stride, size_t outputs,
+                 const T* x, const W* b, T* y,
+                 Function f, const Parameters& p);
+
+    // y[r * y_stride + n] = f(b[n] + W[n] . x[r * stride ...]) for r < rows, n < outputs.
+    void (*gemm)(const W* w, size_t stride, size_t outputs,
+                 const T* x, size_t rows, const W* b, T* y, size_t y_stride,
+                 Function f, const Parameters& p);
+
+    // One backward step of a layer in a single pass over W, for W = T (nullptr otherwise):
+    // dx[k] += sum_n g[n] * W[n][k] with the weights before the update, then
+    // W[n] -= learning_rate * g[n] * x. dx is `stride` long, or nullptr to skip it.
+    void (*backward)(W* w, size_t stride, size_t outputs,
+                     const T* g, const T* x, T learning_rate, T* dx);
+
+    // Sparse layer in SELL-C form with C = MLP_ALIGNMENT / sizeof(T): outputs are cut
+    // into slices of C rows, and slice s holds its rows' nonzeros interleaved, C at a
+    // time (the i-th nonzero of each row, then the (i+1)-th, ...), in
+    // values/columns[slice_start[s] .. slice_start[s + 1]), zero padded to the longest
+    // row of the slice. y is padded to whole slices and its padding is set to 0.
+    // y[n] = f(b[n] + sum of values[i] * x[columns[i]] over row n's entries).
+    void (*sell_gemv)(const uint32_t* slice_start, const uint32_t* columns, const W* values,
+                      size_t outputs, const T* x, const W* b, T* y,
+                      Function f, const Parameters& p);
+
+    // y[i] = f(y[i]) for i < n: the epilogue the kernels above run on each tile.
+    void (*activate)(T* y, size_t n, Function f, const Parameters& p);
+
+    // Output heads: the last layer computed tile by tile as in gemv, reduced in the
+    // same epilogue. gemv_top_k writes the indices of the k largest outputs (k >= 1,
+    // k <= outputs) to top and their values to value, largest first, ties to the
+    // lower index, and stores no other output. gemv_softmax writes softmax(y) to y,
+    // using the fast exponential unless p.accuracy is EXACT.
+    void (*gemv_top_k)(const W* w, size_t stride, size_t outputs,
+                       const T* x, const W* b, Function f, const Parameters& p,
+                       size_t k, size_t* top, T* value);
+    void (*gemv_softmax)(const W* w, size_t stride, size_t outputs,
+                         const T* x, const W* b, T* y,
+                         Function f, const Parameters& p);
+
+    // y[i] += a * x[i] for i < n, n a multiple of MLP_ALIGNMENT / sizeof(T): one
+    // column of a layer applied to its outputs, for incremental passes.
+    void (*axpy)(T a, const W* x, size_t n, T* y);
+};
+
+SimdIsa detect_simd_isa();
+// detect_simd_isa() capped by the MLP_ISA environment variable (scalar, sse2, avx2, avx512).
+SimdIsa selected_simd_isa();
+const char* simd_isa_name(SimdIsa isa);
+
+// Kernels for selected_simd_isa(), picked once. MLP_ISA lets a host pin a lower ISA,
+// e.g. to reproduce results across machines.
+template<typename T, typename W = T>
+const SimdKernels<T, W>& simd_kernels();
+
+// Kernels for `isa`, lowered to what the CPU supports and what was compiled in.
+template<typename T, typename W = T>
+const SimdKernels<T, W>& simd_kernels(SimdIsa isa);
+
+namespace simd_detail {
+    // Defined by the per-ISA translation units; nullptr when the ISA is not built.
+    template<typename T, typename W = T> const SimdKernels<T, W>* sse2_kernels();
+    template<typename T, typename W = T> const SimdKernels<T, W>* avx2_kernels();
+    template<typename T, typename W = T> const SimdKernels<T, W>* avx512_kernels();
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "simdKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("avx2,fma,f16c")
+#include "simdKernelsImpl.hpp"
+
+namespace {
+
+struct Avx2F32 {
+    using scalar = float;
+    using reg = __m256;
+    static constexpr size_t width = 8;
+
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg set1(float v) { return _mm256_set1_ps(v); }
+    static reg load(const float* p) { return _mm256_loadu_ps(p); }
+    static reg load(const float16* p) {
+        return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    static reg load(const bfloat16* p) {
+        const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(bits), 16));
+    }
+    static reg gather(const float* base, const uint32_t* index) {
+        return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index)), 4);
+    }
+    static void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+    static float hsum(reg v) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+};
+
+struct Avx2F64 {
+    using scalar = double;
+    using reg = __m256d;
+    static constexpr size_t width = 4;
+
+    static reg zero() { return _mm256_setzero_pd(); }
+    static reg set1(double v) { return _mm256_set1_pd(v); }
+    static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static reg gather(const double* base, const uint32_t* index) {
+        return _mm256_i32gather_pd(base, _mm_loadu_si128(reinterpret_cast<const __m128i*>(index)), 8);
+    }
+    static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+    static double hsum(reg v) {
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+};
+
+constexpr SimdKernels<float> avx2_f32 = KernelImpl<Avx2F32>::table(SimdIsa::AVX2);
+constexpr SimdKernels<double> avx2_f64 = KernelImpl<Avx2F64>::table(SimdIsa::AVX2);
+constexpr SimdKernels<float, float16> avx2_f16 = KernelImpl<Avx2F32, float16>::table(SimdIsa::AVX2);
+constexpr SimdKernels<float, bfloat16> avx2_bf16 = KernelImpl<Avx2F32, bfloat16>::table(SimdIsa::AVX2);
+
+}
+
+template<> const SimdKernels<float>* simd_detail::avx2_kernels<float>() { return &avx2_f32; }
+template<> const SimdKernels<double>* simd_detail::avx2_kernels<double>() { return &avx2_f64; }
+template<> const SimdKernels<float, bfloat16>* simd_detail::avx2_kernels<float, bfloat16>() { return &avx2_bf16; }
+
+// F16C is a separate CPUID bit, although every AVX2 CPU so far has it.
+template<> const SimdKernels<float, float16>* simd_detail::avx2_kernels<float, float16>() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("f16c") ? &avx2_f16 : nullptr;
+}
+
+#else
+
+template<> const SimdKernels<float>* simd_detail::avx2_kernels<float>() { return nullptr; }
+template<> const SimdKernels<double>* simd_detail::avx2_kernels<double>() { return nullptr; }
+template<> const SimdKernels<float, float16>* simd_detail::avx2_kernels<float, float16>() { return nullptr; }
+template<> const SimdKernels<float, bfloat16>* simd_detail::avx2_kernels<float, bfloat16>() { return nullptr; }
+
+#endif
@@ -0,0 +1,82 @@
+#include "simdKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("avx512f,avx2,fma")
+#include "simdKernelsImpl.hpp"
+
+namespace {
+
+struct Avx512F32 {
+    using scalar = float;
+    using reg = __m512;
+    static constexpr size_t width = 16;
+
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg set1(float v) { return _mm512_set1_ps(v); }
+    static reg load(const float* p) { return _mm512_loadu_ps(p); }
+    static reg load(const float16* p) {
+        return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    }
+    // Widened exactly by a shift. vdpbf16ps would need the inputs in bfloat16 too.
+    static reg load(const bfloat16* p) {
+        const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(bits), 16));
+    }
+    static reg gather(const float* base, const uint32_t* index) {
+        return _mm512_i32gather_ps(_mm512_loadu_si512(index), base, 4);
+    }
+    static void store(float* p, reg v) { _mm512_storeu_ps(p, v); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+    static float hsum(reg v) {
+        __m256 hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+        __m256 h = _mm256_add_ps(_mm512_castps512_ps256(v), hi);
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(h), _mm256_extractf128_ps(h, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+};
+
+struct Avx512F64 {
+    using scalar = double;
+    using reg = __m512d;
+    static constexpr size_t width = 8;
+
+    static reg zero() { return _mm512_setzero_pd(); }
+    static reg set1(double v) { return _mm512_set1_pd(v); }
+    static reg load(const double* p) { return _mm512_loadu_pd(p); }
+    static reg gather(const double* base, const uint32_t* index) {
+        return _mm512_i32gather_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(index)), base, 8);
+    }
+    static void store(double* p, reg v) { _mm512_storeu_pd(p, v); }
+    static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+    static double hsum(reg v) {
+        __m256d h = _mm256_add_pd(_mm512_castpd512_pd256(v), _mm512_extractf64x4_pd(v, 1));
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(h), _mm256_extractf128_pd(h, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+};
+
+constexpr SimdKernels<float> avx512_f32 = KernelImpl<Avx512F32>::table(SimdIsa::AVX512);
+constexpr SimdKernels<double> avx512_f64 = KernelImpl<Avx512F64>::table(SimdIsa::AVX512);
+constexpr SimdKernels<float, float16> avx512_f16 = KernelImpl<Avx512F32, float16>::table(SimdIsa::AVX512);
+constexpr SimdKernels<float, bfloat16> avx512_bf16 = KernelImpl<Avx512F32, bfloat16>::table(SimdIsa::AVX512);
+
+}
+
+template<> const SimdKernels<float>* simd_detail::avx512_kernels<float>() { return &avx512_f32; }
+template<> const SimdKernels<double>* simd_detail::avx512_kernels<double>() { return &avx512_f64; }
+template<> const SimdKernels<float, float16>* simd_detail::avx512_kernels<float, float16>() { return &avx512_f16; }
+template<> const SimdKernels<float, bfloat16>* simd_detail::avx512_kernels<float, bfloat16>() { return &avx512_bf16; }
+
+#else
+
+template<> const SimdKernels<float>* simd_detail::avx512_kernels<float>() { return nullptr; }
+template<> const SimdKernels<double>* simd_detail::avx512_kernels<double>() { return nullptr; }
+template<> const SimdKernels<float, float16>* simd_detail::avx512_kernels<float, float16>() { return nullptr; }
+template<> const SimdKernels<float, bfloat16>* simd_detail::avx512_kernels<float, bfloat16>() { return nullptr; }
+
+#endif
@@ -0,0 +1,299 @@
+// Shared body of the kernels. Each simdKernels*.cpp includes this after
+// selecting its target ISA and instantiates KernelImpl with its register type, so
+// everything here must stay in the anonymous namespace.
+#ifndef SIMD_KERNELS_IMPL_HPP
+#define SIMD_KERNELS_IMPL_HPP
+
+#include <cmath>
+#include <limits>
+#include "simdKernels.h"
+
+namespace {
+
+// V provides: scalar, reg, width, zero(), set1(v), load(p), gather(base, index),
+// store(p, v), add(a, b), fmadd(a, b, c) = a * b + c, and hsum(reg) which folds the
+// register in halves (lane i += lane i + width / 2, ...).
+// Weights are read through load(const W*), which widens them to scalar.
+template<typename V, typename W = typename V::scalar>
+struct KernelImpl {
+    using T = typename V::scalar;
+    using R = typename V::reg;
+    using Function = typename Activator<T>::Function;
+    using Parameters = typename Activator<T>::Parameters;
+
+    static constexpr size_t lanes = MLP_ALIGNMENT / sizeof(T);
+    static constexpr size_t regs = lanes / V::width;
+    // Rows computed together so that each x load feeds several accumulators.
+    static constexpr size_t rows_per_pass = regs >= 8 ? 1 : 8 / regs;
+    // Outputs produced before the activation runs over them.
+    static constexpr size_t tile = 4 * lanes;
+    // gemm register tile: tile_inputs input rows against tile_outputs weight rows,
+    // tile_inputs * tile_outputs * regs accumulators. Measured best of the shapes
+    // that fit the register file.
+    static constexpr size_t tile_inputs = regs >= 8 ? 1 : 2;
+    static constexpr size_t tile_outputs = regs == 1 ? 4 : (regs == 2 ? 3 : 1);
+    // gemm keeps a panel of weight rows this large in L2 while every input row of the
+    // batch passes over it, instead of streaming all of W once per tile of inputs.
+    static constexpr size_t panel_bytes = 128 * 1024;
+    // Weight rows updated per pass of backward(), sharing each dx load and store.
+    static constexpr size_t update_rows = 4;
+
+    static void activate(T* y, size_t n, Function f, const Parameters& p) {
+        Activator<T>::visit(f, p, [y, n](auto fn) {
+            for (size_t i = 0; i < n; i++) {
+                y[i] = fn(y[i]);
+            }
+        });
+    }
+
+    static T reduce(R* acc) {
+        for (size_t half = regs / 2; half > 0; half /= 2) {
+            for (size_t i = 0; i < half; i++) {
+                acc[i] = V::add(acc[i], acc[i + half]);
+            }
+        }
+        return V::hsum(acc[0]);
+    }
+
+    // M input rows against N weight rows: y[m * y_stride + n] = b[n] + W[n] . x[m].
+    // Each dot product accumulates and folds exactly as for any other M and N.
+    template<size_t M, size_t N>
+    static void dot_tile(const W* w, size_t stride, const T* x, const W* b, T* y, size_t y_stride) {
+        R acc[M][N][regs];
+        for (size_t m = 0; m < M; m++) {
+            for (size_t n = 0; n < N; n++) {
+                for (size_t j = 0; j < regs; j++) {
+                    acc[m][n][j] = V::zero();
+                }
+            }
+        }
+        for (size_t k = 0; k < stride; k += lanes) {
+            for (size_t j = 0; j < regs; j++) {
+                R xv[M];
+                for (size_t m = 0; m < M; m++) {
+                    xv[m] = V::load(x + m * stride + k + j * V::width);
+                }
+                for (size_t n = 0; n < N; n++) {
+                    const R wv = V::load(w + n * stride + k + j * V::width);
+                    for (size_t m = 0; m < M; m++) {
+                        acc[m][n][j] = V::fmadd(wv, xv[m], acc[m][n][j]);
+                    }
+                }
+            }
+        }
+        for (size_t m = 0; m < M; m++) {
+            for (size_t n = 0; n < N; n++) {
+                y[m * y_stride + n] = static_cast<T>(b[n]) + reduce(acc[m][n]);
+            }
+        }
+    }
+
+    // Outputs [start, end) for M input rows, then their activation.
+    template<size_t M>
+    static void panel_rows(const W* w, size_t stride, size_t start, size_t end,
+                           const T* x, const W* b, T* y, size_t y_stride,
+                           Function f, const Parameters& p) {
+        size_t n = start;
+        for (; n + tile_outputs <= end; n += tile_outputs) {
+            dot_tile<M, tile_outputs>(w + n * stride, stride, x, b + n, y + n, y_stride);
+        }
+        for (; n < end; n++) {
+            dot_tile<M, 1>(w + n * stride, stride, x, b + n, y + n, y_stride);
+        }
+        for (size_t m = 0; m < M; m++) {
+            activate(y + m * y_stride + start, end - start, f, p);
+        }
+    }
+
+    // Outputs [start, end) of gemv, activated, into y[0 .. end - start).
+    static void gemv_tile(const W* w, size_t stride, size_t start, size_t end,
+                          const T* x, const W* b, T* y,
+                          Function f, const Parameters& p) {
+        size_t n = start;
+        for (; n + rows_per_pass <= end; n += rows_per_pass) {
+            dot_tile<1, rows_per_pass>(w + n * stride, stride, x, b + n, y + n - start, 0);
+        }
+        for (; n < end; n++) {
+            dot_tile<1, 1>(w + n * stride, stride, x, b + n, y + n - start, 0);
+        }
+        activate(y, end - start, f, p);
+    }
+
+    static void gemv(const W* w, size_t stride, size_t outputs,
+                     const T* x, const W* b, T* y,
+                     Function f, const Parameters& p) {
+        for (size_t start = 0; start < outputs; start += tile) {
+            const size_t end = outputs - start < tile ? outputs : start + tile;
+            gemv_tile(w, stride, start, end, x, b, y + start, f, p);
+        }
+    }
+
+    static void axpy(T a, const W* x, size_t n, T* y) {
+        const R av = V::set1(a);
+        for (size_t i = 0; i < n; i += V::width) {
+            V::store(y + i, V::fmadd(V::load(x + i), av, V::load(y + i)));
+        }
+    }
+
+    // Each tile goes through a buffer on the stack and is merged into the top k while
+    // it is in L1; the outputs themselves are never stored.
+    static void gemv_top_k(const W* w, size_t stride, size_t outputs,
+                           const T* x, const W* b, Function f, const Parameters& p,
+                           size_t k, size_t* top, T* value) {
+        alignas(MLP_ALIGNMENT) T y[tile];
+        size_t found = 0;
+        for (size_t start = 0; start < outputs; start += tile) {
+            const size_t end = outputs - start < tile ? outputs : start + tile;
+            gemv_tile(w, stride, start, end, x, b, y, f, p);
+            for (size_t i = 0; i < end - start; i++) {
+                const T v = y[i];
+                if (found == k && !(v > value[k - 1])) continue;
+                size_t at = found < k ? found++ : k - 1;
+                for (; at > 0 && v > value[at - 1]; at--) {
+                    value[at] = value[at - 1];
+                    top[at] = top[at - 1];
+                }
+                value[at] = v;
+                top[at] = start + i;
+            }
+        }
+    }
+
+    // The maximum is taken tile by tile as the outputs are activated; one more pass
+    // exponentiates and sums, and one scales.
+    static void gemv_softmax(const W* w, size_t stride, size_t outputs,
+                             const T* x, const W* b, T* y,
+                             Function f, const Parameters& p) {
+        T max = -std::numeric_limits<T>::infinity();
+        for (size_t start = 0; start < outputs; start += tile) {
+            const size_t end = outputs - start < tile ? outputs : start + tile;
+            gemv_tile(w, stride, start, end, x, b, y + start, f, p);
+            for (size_t i = start; i < end; i++) {
+                max = y[i] > max ? y[i] : max;
+            }
+        }
+        T sum = T(0);
+        if (p.accuracy == Activator<T>::EXACT) {
+            for (size_t i = 0; i < outputs; i++) {
+                y[i] = std::exp(y[i] - max);
+                sum += y[i];
+            }
+        } else {
+            for (size_t i = 0; i < outputs; i++) {
+                y[i] = FastMath<T>::exp(y[i] - max);
+                sum += y[i];
+            }
+        }
+        const T scale = T(1) / sum;
+        for (size_t i = 0; i < outputs; i++) {
+            y[i] *= scale;
+        }
+    }
+
+    static void gemm(const W* w, size_t stride, size_t outputs,
+                     const T* x, size_t rows, const W* b, T* y, size_t y_stride,
+                     Function f, const Parameters& p) {
+        size_t panel = panel_bytes / (stride * sizeof(W)) / tile_outputs * tile_outputs;
+        if (panel < tile_outputs) panel = tile_outputs;
+
+        for (size_t start = 0; start < outputs; start += panel) {
+            const size_t end = outputs - start < panel ? outputs : start + panel;
+            size_t r = 0;
+            for (; r + tile_inputs <= rows; r += tile_inputs) {
+                panel_rows<tile_inputs>(w, stride, start, end, x + r * stride, b,
+                                        y + r * y_stride, y_stride, f, p);
+            }
+            for (; r < rows; r++) {
+                panel_rows<1>(w, stride, start, end, x + r * stride, b,
+                              y + r * y_stride, y_stride, f, p);
+            }
+        }
+    }
+
+    template<size_t Rows, bool Accumulate>
+    static void backward_rows(T* w, size_t stride, const T* g, const T* x, T learning_rate, T* dx) {
+        R grad[Rows], step[Rows];
+        for (size_t r = 0; r < Rows; r++) {
+            grad[r] = V::set1(g[r]);
+            step[r] = V::set1(-(learning_rate * g[r]));
+        }
+        for (size_t k = 0; k < stride; k += V::width) {
+            R d = Accumulate ? V::load(dx + k) : V::zero();
+            const R xv = V::load(x + k);
+            for (size_t r = 0; r < Rows; r++) {
+                T* row = w + r * stride + k;
+                const R wv = V::load(row);
+                if (Accumulate) d = V::fmadd(grad[r], wv, d);
+                V::store(row, V::fmadd(step[r], xv, wv));
+            }
+            if (Accumulate) V::store(dx + k, d);
+        }
+    }
+
+    template<bool Accumulate>
+    static void backward_layer(T* w, size_t stride, size_t outputs,
+                               const T* g, const T* x, T learning_rate, T* dx) {
+        size_t n = 0;
+        for (; n + update_rows <= outputs; n += update_rows) {
+            backward_rows<update_rows, Accumulate>(w + n * stride, stride, g + n, x, learning_rate, dx);
+        }
+        for (; n < outputs; n++) {
+            backward_rows<1, Accumulate>(w + n * stride, stride, g + n, x, learning_rate, dx);
+        }
+    }
+
+    static void backward(T* w, size_t stride, size_t outputs,
+                         const T* g, const T* x, T learning_rate, T* dx) {
+        if (dx) {
+            backward_layer<true>(w, stride, outputs, g, x, learning_rate, dx);
+        } else {
+            backward_layer<false>(w, stride, outputs, g, x, learning_rate, dx);
+        }
+    }
+
+    static constexpr auto backward_kernel() {
+        using Backward = void (*)(W*, size_t, size_t, const T*, const T*, T, T*);
+        if constexpr (std::is_same<W, T>::value) {
+            return Backward(&backward);
+        } else {
+            return Backward(nullptr);
+        }
+    }
+
+    static void sell_gemv(const uint32_t* slice_start, const uint32_t* columns, const W* values,
+                          size_t outputs, const T* x, const W* b, T* y,
+                          Function f, const Parameters& p) {
+        for (size_t start = 0, s = 0; start < outputs; start += lanes, s++) {
+            R acc[regs];
+            for (size_t j = 0; j < regs; j++) {
+                acc[j] = V::zero();
+            }
+            for (size_t i = slice_start[s]; i < slice_start[s + 1]; i += lanes) {
+                for (size_t j = 0; j < regs; j++) {
+                    const size_t at = i + j * V::width;
+                    acc[j] = V::fmadd(V::load(values + at), V::gather(x, columns + at), acc[j]);
+                }
+            }
+            for (size_t j = 0; j < regs; j++) {
+                V::store(y + start + j * V::width, acc[j]);
+            }
+
+            const size_t rows = outputs - start < lanes ? outputs - start : lanes;
+            for (size_t r = 0; r < rows; r++) {
+                y[start + r] += static_cast<T>(b[start + r]);
+            }
+            activate(y + start, rows, f, p);
+            for (size_t r = rows; r < lanes; r++) {
+                y[start + r] = T(0);
+            }
+        }
+    }
+
+    static constexpr SimdKernels<T, W> table(SimdIsa isa) {
+        return {isa, &gemv, &gemm, backward_kernel(), &sell_gemv, &activate, &gemv_top_k, &gemv_softmax, &axpy};
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "simdKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#pragma GCC target("sse2")
+#include "simdKernelsImpl.hpp"
+
+namespace {
+
+struct Sse2F32 {
+    using scalar = float;
+    using reg = __m128;
+    static constexpr size_t width = 4;
+
+    static reg zero() { return _mm_setzero_ps(); }
+    static reg set1(float v) { return _mm_set1_ps(v); }
+    static reg load(const float* p) { return _mm_loadu_ps(p); }
+    // No half conversion instruction before F16C; widen in software.
+    static reg load(const float16* p) { return _mm_setr_ps(p[0], p[1], p[2], p[3]); }
+    static reg load(const bfloat16* p) {
+        const __m128i bits = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), bits));
+    }
+    static reg gather(const float* base, const uint32_t* index) {
+        return _mm_setr_ps(base[index[0]], base[index[1]], base[index[2]], base[index[3]]);
+    }
+    static void store(float* p, reg v) { _mm_storeu_ps(p, v); }
+    static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static float hsum(reg v) {
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+};
+
+struct Sse2F64 {
+    using scalar = double;
+    using reg = __m128d;
+    static constexpr size_t width = 2;
+
+    static reg zero() { return _mm_setzero_pd(); }
+    static reg set1(double v) { return _mm_set1_pd(v); }
+    static reg load(const double* p) { return _mm_loadu_pd(p); }
+    static reg gather(const double* base, const uint32_t* index) {
+        return _mm_setr_pd(base[index[0]], base[index[1]]);
+    }
+    static void store(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static double hsum(reg v) {
+        return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+};
+
+constexpr SimdKernels<float> sse2_f32 = KernelImpl<Sse2F32>::table(SimdIsa::SSE2);
+constexpr SimdKernels<double> sse2_f64 = KernelImpl<Sse2F64>::table(SimdIsa::SSE2);
+constexpr SimdKernels<float, float16> sse2_f16 = KernelImpl<Sse2F32, float16>::table(SimdIsa::SSE2);
+constexpr SimdKernels<float, bfloat16> sse2_bf16 = KernelImpl<Sse2F32, bfloat16>::table(SimdIsa::SSE2);
+
+}
+
+template<> const SimdKernels<float>* simd_detail::sse2_kernels<float>() { return &sse2_f32; }
+template<> const SimdKernels<double>* simd_detail::sse2_kernels<double>() { return &sse2_f64; }
+template<> const SimdKernels<float, float16>* simd_detail::sse2_kernels<float, float16>() { return &sse2_f16; }
+template<> const SimdKernels<float, bfloat16>* simd_detail::sse2_kernels<float, bfloat16>() { return &sse2_bf16; }
+
+#else
+
+template<> const SimdKernels<float>* simd_detail::sse2_kernels<float>() { return nullptr; }
+template<> const SimdKernels<double>* simd_detail::sse2_kernels<double>() { return nullptr; }
+template<> const SimdKernels<float, float16>* simd_detail::sse2_kernels<float, float16>() { return nullptr; }
+template<> const SimdKernels<float, bfloat16>* simd_detail::sse2_kernels<float, bfloat16>() { return nullptr; }
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MLP_SPAN_HPP
+#define MLP_SPAN_HPP
+
+#include <cstddef>
+#include <utility>
+
+// Non-owning view of contiguous values (std::span is C++20).
+template<typename T>
+class Span {
+public:
+    Span() noexcept : ptr(nullptr), count(0) {}
+    Span(T* data, size_t size) noexcept : ptr(data), count(size) {}
+
+    // Any container with data() and size(): std::vector, std::array, AlignedVector, ...
+    template<typename Container,
+             typename = decltype(static_cast<T*>(std::declval<Container&>().data()))>
+    Span(Container& container) noexcept : ptr(container.data()), count(container.size()) {}
+
+    T* data() const noexcept { return ptr; }
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    T* begin() const noexcept { return ptr; }
+    T* end() const noexcept { return ptr + count; }
+    T& operator[](size_t i) const noexcept { return ptr[i]; }
+
+private:
+    T* ptr;
+    size_t count;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "sparsePerceptrone.h"
+
+template<typename T>
+SparsePerceptrone<T>::Workspace::Workspace(const SparsePerceptrone& model) : sizes(model.sizes) {
+    data.resize(model.sizes.size());
+    for (size_t i = 0; i < model.sizes.size(); ++i) {
+        data[i].assign(padded_size<T>(model.sizes[i]), T(0));
+    }
+}
+
+template<typename T>
+void SparsePerceptrone<T>::check_workspace(const Workspace& ws) const {
+    if (ws.sizes != sizes) {
+        throw std::invalid_argument("Workspace does not match network structure");
+    }
+}
+
+template<typename T>
+SparsePerceptrone<T>::SparsePerceptrone(const std::vector<size_t>& neurons,
+        const std::vector<typename Activator<T>::Function>& activate,
+        const typename Activator<T>::Parameters& parameters,
+        double max_density)
+    : SparsePerceptrone(Perceptrone<T>(neurons, activate, T(0), parameters), max_density) {}
+
+template<typename T>
+SparsePerceptrone<T>::SparsePerceptrone(const Perceptrone<T>& model, double max_density)
+    : sizes(model.get_sizes()),
+      activations(model.get_activations()),
+      activationParameters(model.get_activation_parameters()),
+      maxDensity(max_density),
+      kernels(&simd_kernels<T>()) {
+    build(model);
+    workspace = Workspace(*this);
+}
+
+template<typename T>
+void SparsePerceptrone<T>::build(const Perceptrone<T>& model) {
+    const auto biases = model.get_biases();
+    layers.assign(sizes.size() - 1, Layer());
+
+    for (size_t l = 0; l < layers.size(); l++) {
+        LayerView<T> view = model.layer_weights(l);
+        Layer& layer = layers[l];
+        layer.bias = biases[l + 1];
+
+        size_t count = 0;
+        for (size_t n = 0; n < view.outputs; n++) {
+            const T* row = view.row(n);
+            count += view.inputs - std::count(row, row + view.inputs, T(0));
+        }
+        layer.sparse = double(count) <= maxDensity * double(view.inputs * view.outputs);
+
+        if (!layer.sparse) {
+            layer.dense.assign(view.data, view.data + view.outputs * view.stride);
+            continue;
+        }
+
+        // Each slice is as long as its longest row; shorter rows are padded with
+        // zero weights pointing at column 0.
+        constexpr size_t slice = padded_size<T>(1);
+        layer.slice_start.push_back(0);
+        for (size_t start = 0; start < view.outputs; start += slice) {
+            const size_t rows = std::min(slice, view.outputs - start);
+            std::vector<std::vector<uint32_t>> nonzero(rows);
+            size_t longest = 0;
+            for (size_t r = 0; r < rows; r++) {
+                const T* row = view.row(start + r);
+                for (size_t k = 0; k < view.inputs; k++) {
+                    if (row[k] != T(0)) nonzero[r].push_back(static_cast<uint32_t>(k));
+                }
+                longest = std::max(longest, nonzero[r].size());
+            }
+            for (size_t i = 0; i < longest; i++) {
+                for (size_t r = 0; r < slice; r++) {
+                    const bool present = r < rows && i < nonzero[r].size();
+                    const uint32_t k = present ? nonzero[r][i] : 0;
+                    layer.columns.push_back(k);
+                    layer.values.push_back(present ? view(k, start + r) : T(0));
+                }
+            }
+            layer.slice_start.push_back(static_cast<uint32_t>(layer.values.size()));
+        }
+    }
+}
+
+template<typename T>
+std::vector<T> SparsePerceptrone<T>::predict(const std::vector<T>& input) {
+    if (input.size() != sizes.front()) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+    std::vector<T> output(sizes.back());
+    predict_into(workspace, input.data(), output.data());
+    return output;
+}
+
+template<typename T>
+void SparsePerceptrone<T>::predict_into(const T* input, T* output) {
+    predict_into(workspace, input, output);
+}
+
+template<typename T>
+void SparsePerceptrone<T>::predict_into(Workspace& ws, const T* input, T* output) const {
+    check_workspace(ws);
+    auto& data = ws.data;
+    std::copy(input, input + sizes.front(), data[0].begin());
+
+    for (size_t l = 0; l < layers.size(); l++) {
+        const Layer& layer = layers[l];
+        const T* x = data[l].data();
+        T* y = data[l + 1].data();
+        if (layer.sparse) {
+            kernels->sell_gemv(layer.slice_start.data(), layer.columns.data(), layer.values.data(),
+                               sizes[l + 1], x, layer.bias.data(), y,
+                               activations[l], activationParameters);
+        } else {
+            kernels->gemv(layer.dense.data(), padded_size<T>(sizes[l]), sizes[l + 1],
+                          x, layer.bias.data(), y, activations[l], activationParameters);
+        }
+    }
+
+    std::copy(data.back().begin(), data.back().begin() + sizes.back(), output);
+}
+
+template<typename T>
+size_t SparsePerceptrone<T>::nonzeros() const {
+    size_t count = 0;
+    for (size_t l = 0; l < layers.size(); l++) {
+        const Layer& layer = layers[l];
+        const auto& stored = layer.sparse ? layer.values : layer.dense;
+        count += stored.size() - std::count(stored.begin(), stored.end(), T(0));
+    }
+    return count;
+}
+
+template<typename T>
+void SparsePerceptrone<T>::load_weights(const std::string& filename) {
+    Perceptrone<T> model(sizes, activations, T(0), activationParameters);
+    model.load_weights(filename);
+    build(model);
+}
+
+template class SparsePerceptrone<float>;
+template class SparsePerceptrone<double>;
@@ -0,0 +1,111 @@
+#ifndef SPARSE_PERCEPTRONE_H
+#define SPARSE_PERCEPTRONE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Perceptrone.h"
+
+// Zeroes the smallest-magnitude weights of each layer so that a `sparsity` fraction
+// of them (0..1) is zero. Biases are kept. Returns the number of weights pruned.
+template<typename T, typename Storage>
+size_t prune_by_magnitude(Perceptrone<T, Storage>& model, double sparsity) {
+    if (!(sparsity >= 0.0 && sparsity <= 1.0)) {
+        throw std::invalid_argument("Sparsity must be between 0 and 1");
+    }
+
+    auto weights = model.get_weights();
+    std::vector<std::pair<T, T*>> order;
+    size_t pruned = 0;
+    for (auto& layer : weights) {
+        order.clear();
+        for (auto& row : layer) {
+            for (auto& w : row) {
+                order.emplace_back(std::abs(w), &w);
+            }
+        }
+        const size_t count = static_cast<size_t>(sparsity * double(order.size()));
+        std::nth_element(order.begin(), order.begin() + count, order.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (size_t i = 0; i < count; i++) {
+            *order[i].second = T(0);
+        }
+        pruned += count;
+    }
+    model.set_weights(weights);
+    return pruned;
+}
+
+// Inference-only copy of a Perceptrone<T> that skips zero weights. Layers whose
+// share of nonzero weights is at most `max_density` are stored in SELL-C form, a
+// sliced CSR that keeps C rows' nonzeros interleaved so one gather and one
+// multiply-add advance C rows at once (see SimdKernels::sell_gemv). Denser layers
+// stay dense, where the regular kernels are faster.
+template<typename T>
+class SparsePerceptrone {
+public:
+    class Workspace {
+    public:
+        Workspace() = default;
+        explicit Workspace(const SparsePerceptrone& model);
+
+    private:
+        friend class SparsePerceptrone;
+
+        std::vector<size_t> sizes;
+        // data[layer] is padded to padded_size<T>(sizes[layer]), padding stays zero.
+        std::vector<AlignedVector<T>> data;
+    };
+
+    SparsePerceptrone(const std::vector<size_t>& neurons,
+        const std::vector<typename Activator<T>::Function>& activate,
+        const typename Activator<T>::Parameters& parameters = {},
+        double max_density = 0.3);
+    explicit SparsePerceptrone(const Perceptrone<T>& model, double max_density = 0.3);
+
+    Workspace make_workspace() const { return Workspace(*this); }
+
+    std::vector<T> predict(const std::vector<T>& input);
+    void predict_into(const T* input, T* output);
+    // Throws std::invalid_argument if ws was made for other layer sizes.
+    void predict_into(Workspace& ws, const T* input, T* output) const;
+
+    const std::vector<size_t>& get_sizes() const { return sizes; }
+    bool is_sparse(size_t layer) const { return layers[layer].sparse; }
+    size_t nonzeros() const;
+
+    // Reads a dense weights file and rebuilds the layers from it.
+    void load_weights(const std::string& filename);
+
+private:
+    struct Layer {
+        bool sparse;
+        // SELL-C, as laid out for SimdKernels::sell_gemv.
+        std::vector<uint32_t> slice_start;
+        std::vector<uint32_t> columns;
+        AlignedVector<T> values;
+        // Dense: sizes[l + 1] x padded_size<T>(sizes[l]), zero padded.
+        AlignedVector<T> dense;
+        std::vector<T> bias;
+    };
+
+    void check_workspace(const Workspace& ws) const;
+
+    std::vector<size_t> sizes;
+    std::vector<Layer> layers;
+    std::vector<typename Activator<T>::Function> activations;
+    typename Activator<T>::Parameters activationParameters;
+    double maxDensity;
+    const SimdKernels<T>* kernels;
+    Workspace workspace;
+
+    void build(const Perceptrone<T>& model);
+};
+
+extern template class SparsePerceptrone<float>;
+extern template class SparsePerceptrone<double>;
+
+#endif
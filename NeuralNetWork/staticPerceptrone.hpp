@@ -0,0 +1,186 @@
+#ifndef STATIC_PERCEPTRONE_HPP
+#define STATIC_PERCEPTRONE_HPP
+
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Perceptrone.h"
+
+template<typename T, typename Activator<T>::Function... Functions>
+struct Activations {
+    static constexpr size_t size = sizeof...(Functions);
+    static constexpr std::array<typename Activator<T>::Function, size> list = {Functions...};
+};
+
+// Perceptrone with topology and activations fixed at compile time, e.g.
+//   StaticPerceptrone<float, Activations<float, A::RELU, A::RELU, A::IDENTITY>, 8, 64, 64, 4>
+// Parameters live in std::arrays inside the object and every loop bound is a
+// constant, so inference does no allocation and no size checks. Weights are kept
+// input-major, as in the weights file, so each layer vectorizes across neurons.
+// Reads and writes the same weights files as Perceptrone<T>, and reads its model
+// files (from_file), the form trained models are shipped in.
+template<typename T, typename Acts, size_t... Sizes>
+class StaticPerceptrone {
+public:
+    static constexpr size_t num_layers = sizeof...(Sizes);
+    static constexpr std::array<size_t, num_layers> sizes = {Sizes...};
+    static constexpr size_t inputs = sizes.front();
+    static constexpr size_t outputs = sizes.back();
+
+    static_assert(num_layers >= 2, "Network must have at least 2 layers");
+    static_assert(Acts::size == num_layers - 1, "Mismatch between layers and activations");
+
+private:
+    static constexpr size_t weight_offset(size_t layer) {
+        size_t offset = 0;
+        for (size_t i = 0; i < layer; i++) offset += sizes[i] * sizes[i + 1];
+        return offset;
+    }
+
+    static constexpr size_t bias_offset(size_t layer) {
+        size_t offset = 0;
+        for (size_t i = 0; i < layer; i++) offset += sizes[i];
+        return offset;
+    }
+
+    static constexpr size_t max_width() {
+        size_t width = 0;
+        for (size_t i = 1; i + 1 < num_layers; i++) width = sizes[i] > width ? sizes[i] : width;
+        return width > 0 ? width : 1;
+    }
+
+    // weights[weight_offset(l) + prev * sizes[l + 1] + neuron]
+    alignas(MLP_ALIGNMENT) std::array<T, weight_offset(num_layers - 1)> weights{};
+    // Includes the unused input-layer biases so files round-trip unchanged.
+    alignas(MLP_ALIGNMENT) std::array<T, bias_offset(num_layers)> bias{};
+    typename Activator<T>::Parameters activationParameters;
+
+    template<size_t L>
+    void layer(const T* x, T* y) const {
+        constexpr size_t in = sizes[L];
+        constexpr size_t out = sizes[L + 1];
+        const T* w = weights.data() + weight_offset(L);
+        const T* b = bias.data() + bias_offset(L + 1);
+
+        for (size_t neuron = 0; neuron < out; neuron++) {
+            y[neuron] = b[neuron];
+        }
+        for (size_t prev_neuron = 0; prev_neuron < in; prev_neuron++) {
+            const T xi = x[prev_neuron];
+            const T* row = w + prev_neuron * out;
+            for (size_t neuron = 0; neuron < out; neuron++) {
+                y[neuron] += row[neuron] * xi;
+            }
+        }
+        Activator<T>::apply(Acts::list[L], y, out, activationParameters);
+    }
+
+    // Layer L reads the buffer layer L - 1 wrote; the last layer writes to output.
+    template<size_t L>
+    void step(const T* input, T* a, T* b, T* output) const {
+        const T* x = L == 0 ? input : (L % 2 == 1 ? a : b);
+        T* y = L + 2 == num_layers ? output : (L % 2 == 0 ? a : b);
+        layer<L>(x, y);
+    }
+
+    template<size_t... L>
+    void forward(const T* input, T* output, std::index_sequence<L...>) const {
+        alignas(MLP_ALIGNMENT) T a[max_width()];
+        alignas(MLP_ALIGNMENT) T b[max_width()];
+        (step<L>(input, a, b, output), ...);
+    }
+
+public:
+    StaticPerceptrone(const typename Activator<T>::Parameters& parameters = {})
+        : activationParameters(parameters) {}
+
+    explicit StaticPerceptrone(const Perceptrone<T>& model)
+        : activationParameters(model.get_activation_parameters()) {
+        if (model.get_sizes() != std::vector<size_t>(sizes.begin(), sizes.end())) {
+            throw std::invalid_argument("Network structure mismatch");
+        }
+        const auto& functions = model.get_activations();
+        for (size_t i = 0; i < Acts::size; i++) {
+            if (functions[i] != Acts::list[i]) {
+                throw std::invalid_argument("Activation mismatch in layer " + std::to_string(i));
+            }
+        }
+
+        for (size_t l = 0; l + 1 < num_layers; l++) {
+            LayerView<T> view = model.layer_weights(l);
+            T* w = weights.data() + weight_offset(l);
+            for (size_t j = 0; j < sizes[l]; j++) {
+                for (size_t k = 0; k < sizes[l + 1]; k++) {
+                    w[j * sizes[l + 1] + k] = view(j, k);
+                }
+            }
+        }
+        const auto& biases = model.get_biases();
+        for (size_t l = 0; l < num_layers; l++) {
+            std::copy(biases[l].begin(), biases[l].end(), bias.begin() + bias_offset(l));
+        }
+    }
+
+    // Reads a model file of T values (Perceptrone::save, see modelFile.h); throws if
+    // its layer sizes or activations differ from the template arguments.
+    static StaticPerceptrone from_file(const std::string& filename) {
+        return StaticPerceptrone(Perceptrone<T>::from_file(filename));
+    }
+
+    // Reads `inputs` values and writes `outputs` values; output must not alias input.
+    void predict(const T* input, T* output) const {
+        forward(input, output, std::make_index_sequence<num_layers - 1>());
+    }
+
+    std::array<T, outputs> predict(const std::array<T, inputs>& input) const {
+        std::array<T, outputs> output;
+        predict(input.data(), output.data());
+        return output;
+    }
+
+    std::vector<T> predict(const std::vector<T>& input) const {
+        if (input.size() != inputs) {
+            throw std::invalid_argument("Input size mismatch");
+        }
+        std::vector<T> output(outputs);
+        predict(input.data(), output.data());
+        return output;
+    }
+
+    void save_weights(const std::string& filename) const {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open file for writing");
+
+        size_t layers = num_layers;
+        file.write(reinterpret_cast<const char*>(&layers), sizeof(layers));
+        file.write(reinterpret_cast<const char*>(sizes.data()), sizeof(size_t) * num_layers);
+        file.write(reinterpret_cast<const char*>(weights.data()), sizeof(T) * weights.size());
+        file.write(reinterpret_cast<const char*>(bias.data()), sizeof(T) * bias.size());
+    }
+
+    void load_weights(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open file for reading");
+
+        size_t layers;
+        file.read(reinterpret_cast<char*>(&layers), sizeof(layers));
+        if (layers != num_layers) {
+            throw std::runtime_error("Network structure mismatch");
+        }
+        for (size_t i = 0; i < num_layers; i++) {
+            size_t size;
+            file.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (size != sizes[i]) {
+                throw std::runtime_error("Layer size mismatch");
+            }
+        }
+        file.read(reinterpret_cast<char*>(weights.data()), sizeof(T) * weights.size());
+        file.read(reinterpret_cast<char*>(bias.data()), sizeof(T) * bias.size());
+        if (!file) throw std::runtime_error("Unexpected end of weights file");
+    }
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "threadPool.h"
+
+ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 1; i < threads; i++) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t tasks, Task fn, void* ctx) {
+    if (workers.empty() || tasks <= 1) {
+        for (size_t i = 0; i < tasks; i++) {
+            fn(ctx, i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(callMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = fn;
+        context = ctx;
+        taskCount = tasks;
+        next.store(0, std::memory_order_relaxed);
+        active = workers.size();
+        generation++;
+    }
+    start.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return active == 0; });
+}
+
+void ThreadPool::drain() {
+    for (size_t i = next.fetch_add(1); i < taskCount; i = next.fetch_add(1)) {
+        task(context, i);
+    }
+}
+
+void ThreadPool::work() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        start.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+
+        if (--active == 0) done.notify_one();
+    }
+}
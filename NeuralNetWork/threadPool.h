@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads for splitting one forward pass across cores. Workers
+// sleep between calls; parallel_for wakes them, works alongside them and returns
+// when every task is done. Nothing is allocated per call.
+class ThreadPool {
+public:
+    // `threads` counts the calling thread, so ThreadPool(1) starts no workers.
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that run tasks, including the caller of parallel_for.
+    size_t size() const { return workers.size() + 1; }
+
+    // Calls f(i) for every i < tasks. Calls from several threads are serialized.
+    template<typename F>
+    void parallel_for(size_t tasks, F&& f) {
+        using Fn = std::remove_reference_t<F>;
+        run(tasks, [](void* context, size_t i) { (*static_cast<Fn*>(context))(i); },
+            const_cast<void*>(static_cast<const void*>(&f)));
+    }
+
+private:
+    using Task = void (*)(void* context, size_t index);
+
+    void run(size_t tasks, Task task, void* context);
+    void drain();
+    void work();
+
+    std::vector<std::thread> workers;
+    std::mutex callMutex;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    // The current call, written under `mutex` before workers are woken.
+    Task task = nullptr;
+    void* context = nullptr;
+    size_t taskCount = 0;
+    std::atomic<size_t> next{0};
+    size_t active = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+#endif
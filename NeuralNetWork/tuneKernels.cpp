@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "kernelTuner.h"
+
+using namespace std;
+
+// MLPTune <model.mlp> [--threads N] [--cache FILE]
+// Times the kernel candidates of every layer of a model file on this host (see
+// kernelTuner.h) and prints the picks. With --cache the picks are read from FILE
+// when it already covers the model on this host, and added to it otherwise, which
+// is what a program does at startup with KernelTuningCache::plan.
+template<typename T, typename Storage>
+void tune(const char* filename, ThreadPool* pool, const char* cache_file) {
+    Perceptrone<T, Storage> model = Perceptrone<T, Storage>::from_file(filename);
+    const vector<size_t>& sizes = model.get_sizes();
+    printf("%s, %s, потоков %zu\n", filename, cpu_model_name().c_str(), pool ? pool->size() : size_t(1));
+
+    vector<LayerKernelChoice> plan;
+    if (cache_file) {
+        KernelTuningCache cache(cache_file);
+        plan = cache.plan(model, pool);
+        printf("Кэш %s: настроено форм слоёв %zu\n", cache_file, cache.tuned_shapes());
+    } else {
+        const TunedPlan tuned = tune_kernels(model, pool);
+        printf("Проход: %.0f нс по умолчанию, %.0f нс после настройки\n",
+               tuned.default_pass_ns, tuned.pass_ns);
+        plan = tuned.plan;
+    }
+    for (size_t l = 0; l < plan.size(); l++) {
+        printf("Слой %zu, %zux%zu: %s%s\n", l, sizes[l], sizes[l + 1], simd_isa_name(plan[l].isa),
+               plan[l].threaded ? ", на пуле потоков" : "");
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t threads = 1;
+    const char* cache_file = nullptr;
+    for (int i = 2; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--cache") == 0 && has_value) {
+            cache_file = argv[++i];
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if (argc < 2 || threads == 0) {
+        fprintf(stderr, "Использование: %s <модель.mlp> [--threads N] [--cache ФАЙЛ]\n", argv[0]);
+        return 2;
+    }
+    try {
+        unique_ptr<ThreadPool> pool;
+        if (threads > 1) pool.reset(new ThreadPool(threads));
+
+        ifstream file(argv[1], ios::binary);
+        if (!file) throw runtime_error("Cannot open file for reading");
+        const ModelHeader header = read_model_header(file);
+        file.close();
+
+        if (header.compute_type == ValueType::FLOAT64) {
+            tune<double, double>(argv[1], pool.get(), cache_file);
+        } else if (header.storage_type == ValueType::FLOAT16) {
+            tune<float, float16>(argv[1], pool.get(), cache_file);
+        } else if (header.storage_type == ValueType::BFLOAT16) {
+            tune<float, bfloat16>(argv[1], pool.get(), cache_file);
+        } else {
+            tune<float, float>(argv[1], pool.get(), cache_file);
+        }
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}